@@ -2,6 +2,11 @@
 #include <unordered_map>
 
 #include "tile.hpp"
+#include "tile_active.hpp"
+#include "rule_jit.hpp"
+#include "tile_family.hpp"
+#include "tile_plane.hpp"
+#include "hashlife.hpp"
 
 #include "common.hpp"
 
@@ -22,6 +27,12 @@ static bool strobing(const aniso::ruleT& rule) {
 
 static const int step_fast = 10;
 
+// For the preview windows. (The space window has its own pool in the simulation thread.)
+static aniso::worker_poolT& worker_pool() {
+    static aniso::worker_poolT pool{};
+    return pool;
+}
+
 static int adjust_step(int step, const aniso::ruleT& rule) {
     if ((step % 2) && strobing(rule)) {
         return step + 1;
@@ -29,11 +40,35 @@ static int adjust_step(int step, const aniso::ruleT& rule) {
     return step;
 }
 
-//           q w -
-//           a s d
-// Works for - x c case (~ rules in 'Hex' subset).
-static void hex_image(const aniso::tile_const_ref source, const aniso::vecT /*source*/ center,
-                      const aniso::vecT window_size, const double hex_d /*distance between adjacent centers*/) {
+// For the "max speed" mode, where the step is decided by the measured cost instead.
+static constexpr double budget_ms = 12;
+static int budget_step(const double ms_per_gen) { //
+    return std::clamp(int(budget_ms / std::max(ms_per_gen, 1e-4)), 1, 100000);
+}
+static void update_cost(double& ms_per_gen, const int gens, const double ms) {
+    if (gens > 0) {
+        ms_per_gen = 0.75 * ms_per_gen + 0.25 * (ms / gens); // (Moving average.)
+    }
+}
+
+// The cell (relative to the center) shown at each pixel of the window, cached by (window_size, hex_d), so that
+// `hex_image` only needs to gather the cells in each frame.
+static const std::vector<aniso::vecT>& hex_map(const aniso::vecT window_size, const double hex_d) {
+    struct mapT {
+        aniso::vecT window_size;
+        double hex_d;
+        std::vector<aniso::vecT> map;
+    };
+    static std::vector<mapT> cache;
+    for (const mapT& m : cache) {
+        if (m.window_size == window_size && m.hex_d == hex_d) {
+            return m.map;
+        }
+    }
+    if (cache.size() >= 8) { // (There are usually only a few kinds in use.)
+        cache.clear();
+    }
+
     const auto rel_pos = [](const double x, const double y /*normalized, relative to a center*/) -> aniso::vecT {
         // q w -     q w -
         // a s d ~  a s d (1,0)
@@ -70,18 +105,33 @@ static void hex_image(const aniso::tile_const_ref source, const aniso::vecT /*so
         return {.x = dx, .y = dy};
     };
 
-    aniso::tileT dest(window_size);
-    const auto dest_data = dest.data();
+    std::vector<aniso::vecT> map(window_size.xy());
     const double _1_div_hex_d = 1.0 / hex_d;
     for (int y = 0; y < window_size.y; ++y) {
         for (int x = 0; x < window_size.x; ++x) {
-            const auto pos =
-                center + rel_pos((x - window_size.x / 2) * _1_div_hex_d, (y - window_size.y / 2) * _1_div_hex_d);
-            if (source.contains(pos)) {
-                dest_data.at(x, y) = source.at(pos);
-            } else {
-                dest_data.at(x, y) = (x + y) & 1; // Checkerboard texture.
-            }
+            map[y * window_size.x + x] =
+                rel_pos((x - window_size.x / 2) * _1_div_hex_d, (y - window_size.y / 2) * _1_div_hex_d);
+        }
+    }
+    cache.push_back({.window_size = window_size, .hex_d = hex_d, .map = std::move(map)});
+    return cache.back().map;
+}
+
+//           q w -
+//           a s d
+// Works for - x c case (~ rules in 'Hex' subset).
+static void hex_image(const aniso::tile_const_ref source, const aniso::vecT /*source*/ center,
+                      const aniso::vecT window_size, const double hex_d /*distance between adjacent centers*/) {
+    const std::vector<aniso::vecT>& map = hex_map(window_size, hex_d);
+    static aniso::tileT dest; // (Reused.)
+    dest.resize(window_size);
+    const auto dest_data = dest.data();
+    for (int y = 0; y < window_size.y; ++y) {
+        bool* const line = dest_data.line(y);
+        const aniso::vecT* const rel = map.data() + y * window_size.x;
+        for (int x = 0; x < window_size.x; ++x) {
+            const aniso::vecT pos = center + rel[x];
+            line[x] = source.contains(pos) ? source.at(pos) : (x + y) & 1; // Checkerboard texture.
         }
     }
 
@@ -117,91 +167,157 @@ static bool want_hex_mode(const aniso::ruleT& rule) {
 }
 #endif
 
-// TODO: error-prone. Should work in a way similar to `identify`.
+// 64-bit hash of the cells (and the size).
+static uint64_t hash_tile(const aniso::tile_const_ref tile) {
+    uint64_t hash = (uint64_t(tile.size.x) << 32) | uint64_t(tile.size.y);
+    const auto mix = [&hash](uint64_t v) { hash = (std::rotl(hash, 23) ^ v) * 0x9e37'79b9'7f4a'7c15; };
+    tile.for_each_line([&](int, std::span<const bool> line) {
+        for (; line.size() >= 8; line = line.subspan(8)) {
+            uint64_t word;
+            std::memcpy(&word, line.data(), 8);
+            mix(word);
+        }
+        uint64_t tail = 1;
+        for (const bool b : line) {
+            tail = (tail << 1) | b;
+        }
+        mix(tail);
+    });
+    return hash;
+}
+
 // Copy the subrange and run as a torus space, recording all invoked mappings.
+// The run stops when the torus returns to a previous state, so every mapping the torus can ever invoke is recorded
+// by then. (The states are remembered by hash; a repeated hash is confirmed by running another period and
+// comparing exactly, so the run stops within mu + 2p generations, where mu is the length of the transient and p is
+// the period.)
 // This is only good at capturing simple, "self-contained" patterns (oscillators/spaceships).
 // For more complex situations, the program has "open-capture" (`fake_apply`) to record
 // areas frame-by-frame.
-static aniso::lockT capture_closed(const aniso::tile_const_ref tile, const aniso::ruleT& rule) {
-    aniso::lockT lock{};
-    aniso::tileT torus(tile);
-
-    // (wontfix) It's possible that the loop fails to catch all invocations in very rare cases,
-    // due to that `limit` is not large enough.
-
-    // Loop until there has been `limit` generations without newly invoked mappings.
-    const int limit = 120;
-    for (int g = limit; g > 0; --g) {
-        torus.run_torus([&](const aniso::codeT code) {
-            if (!lock[code]) {
-                g = limit;
-                lock[code] = true;
+// (The period can be extremely long for chaotic areas, so the run also stops after calculating `max_cost` cells,
+// which takes ~0.1s, and the result may be incomplete in this case.)
+// (Currently unused; the call site is disabled along with the lock in the editor.)
+static aniso::lockT capture_closed(const aniso::tile_const_ref tile, const aniso::ruleT& rule,
+                                  int* const run_gens = nullptr) {
+    constexpr int64_t max_cost = int64_t(1) << 25;
+    const int max_gens = std::min(max_cost / tile.size.xy(), int64_t(1) << 20);
+
+    aniso::code_bitsT invoked{}; // (Recorded by the stepping kernel.)
+    aniso::tileT torus(tile), saved(tile);
+    aniso::torus_stepperT stepper{};
+    std::unordered_map<uint64_t, int> seen{{hash_tile(torus.data()), 0}}; // Hash -> generation.
+    int g = 0, confirm_at = -1; // (If >= 0, `saved` is expected to reappear at `confirm_at`.)
+    while (g < max_gens && !invoked.all()) {
+        stepper.run_torus(rule, torus.data(), 1, invoked);
+        ++g;
+        if (g == confirm_at) {
+            if (torus == saved) {
+                break;
             }
-            return rule[code];
-        });
+            confirm_at = -1; // (Hash collision.)
+        }
+        const auto [find, inserted] = seen.try_emplace(hash_tile(torus.data()), g);
+        if (!inserted && confirm_at < 0) {
+            aniso::copy(saved.data(), torus.data());
+            confirm_at = g + (g - find->second);
+        }
+    }
+    if (run_gens) {
+        *run_gens = g;
     }
 
+    aniso::lockT lock{};
+    invoked.merge_into(lock);
     return lock;
 }
 
-// Identify spaceships or oscillators in 2*2 periodic (including pure) background. (Cannot deal with non-trivial
-// objects like guns, puffers etc.)
-// The area should be fully surrounded by 2*2 periodic border, and contain a full phase of the object (one or
-// several oscillators, or a single spaceship).
-// TODO: should be able to deal with larger periods in the future... (notice the error messages are currently
-// hard-coded.)
-static void identify(const aniso::tile_const_ref tile, const aniso::ruleT& rule,
-                     const bool require_matching_background = true) {
-    static constexpr aniso::vecT period_size{2, 2};
-    struct periodT {
-        std::array<bool, period_size.x * period_size.y> m_data{};
-
-        bool operator==(const periodT&) const = default;
-
-        static aniso::vecT size() { return period_size; }
-        aniso::tile_ref data() { return {m_data.data(), period_size}; }
-        aniso::tile_const_ref data() const { return {m_data.data(), period_size}; }
-
-        bool is_periodic(const aniso::ruleT& rule) const {
-            periodT torus = *this;
-            for (int g = 0; g < (1 << (period_size.x * period_size.y)); ++g) {
-                aniso::apply_rule_torus(rule, torus.data());
-                if (torus == *this) {
-                    return true;
-                }
-            }
-            return false;
-        }
-        bool rotate_equal(const periodT& b) const {
-            for (int dy = 0; dy < period_size.y; ++dy) {
-                for (int dx = 0; dx < period_size.x; ++dx) {
-                    periodT ro{};
-                    aniso::rotate_copy_00_to(ro.data(), data(), {.x = dx, .y = dy});
-                    if (ro == b) {
-                        return true;
-                    }
+#ifdef ENABLE_TESTS
+namespace aniso::_tests {
+    static const testT test_capture_closed = [] {
+        // Run until the state repeats, with every state kept.
+        const auto exhaustive = [](const tile_const_ref tile, const ruleT& rule, int& mu, int& p) {
+            lockT lock{};
+            std::vector<tileT> states{};
+            states.emplace_back(tile);
+            for (;;) {
+                tileT next(states.back());
+                next.run_torus([&](const codeT code) {
+                    lock[code] = true;
+                    return rule[code];
+                });
+                const auto find = std::ranges::find(states, next);
+                if (find != states.end()) {
+                    mu = find - states.begin();
+                    p = states.size() - mu;
+                    return lock;
                 }
+                states.push_back(std::move(next));
             }
-            return false;
+        };
+        const auto test = [&](const tile_const_ref tile, const ruleT& rule) {
+            int mu = 0, p = 0, gens = 0;
+            const lockT expected = exhaustive(tile, rule, mu, p);
+            const lockT lock = capture_closed(tile, rule, &gens);
+            assert(lock == expected);
+            lockT all{};
+            all.fill(true);
+            assert(gens <= mu + 2 * p || lock == all); // (Or stopped early, as all the codes are invoked.)
+        };
+
+        const ruleT life = game_of_life();
+        tileT tile({10, 10});
+        tile.data().at(4, 4) = tile.data().at(5, 4) = tile.data().at(6, 4) = true; // Blinker.
+        test(tile.data(), life);
+        fill(tile.data(), false);
+        tile.data().at(2, 1) = tile.data().at(3, 2) = tile.data().at(1, 3) = true; // Glider.
+        tile.data().at(2, 3) = tile.data().at(3, 3) = true;
+        test(tile.data(), life);
+        fill(tile.data(), false);
+        tile.data().at(1, 1) = tile.data().at(2, 1) = tile.data().at(3, 1) = true; // -> Blinker.
+        tile.data().at(2, 2) = true;
+        test(tile.data(), life);
+
+        // (Small enough that the states always repeat soon.)
+        for (int i = 0; i < 10; ++i) {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            tileT soup({4, 3});
+            random_fill(soup.data(), testT::rand, 0.5);
+            test(soup.data(), rule);
         }
     };
+} // namespace aniso::_tests
+#endif // ENABLE_TESTS
 
-    static const auto take_corner = [](const aniso::tile_const_ref tile) {
-        assert(tile.size.both_gteq(period_size));
-        periodT p{};
-        aniso::copy(p.data(), tile.clip({{0, 0}, period_size}));
-        return p;
+// Identify spaceships or oscillators in periodic (including pure) background, whose spatial period is at most
+// 4*4 (as `initT::background`). (Cannot deal with non-trivial objects like guns, puffers etc.)
+// The area should be fully surrounded by periodic border (at least a period wide), and contain a full phase of
+// the object (one or several oscillators, or a single spaceship), or something that evolves to such an object.
+static void identify(const aniso::tile_const_ref tile, const aniso::ruleT& rule,
+                     const bool require_matching_background = true) {
+    static constexpr aniso::vecT max_period_size{4, 4};
+
+    static const auto is_periodic = [](const aniso::tile_const_ref background, const aniso::ruleT& rule) {
+        aniso::tileT torus(background);
+        aniso::torus_stepperT stepper{};
+        for (int g = 0; g < (1 << background.size.xy()); ++g) {
+            stepper.run_torus(rule, torus.data(), 1);
+            if (aniso::equal(torus.data(), background)) {
+                return true;
+            }
+        }
+        return false;
     };
-    static const auto locate_pattern = [](const aniso::tile_const_ref tile,
+    // (The returned range includes the background border, which is a period wide.)
+    static const auto locate_pattern = [](const aniso::tile_const_ref tile, const aniso::vecT period_size,
                                           const bool for_input = false) -> std::optional<aniso::rangeT> {
         assert(tile.size.both_gt(period_size * 2));
-        const aniso::rangeT range = aniso::bounding_box(tile, take_corner(tile).data());
+        const aniso::rangeT range = aniso::bounding_box(tile, tile.clip({{0, 0}, period_size}));
         if (range.empty()) {
             messenger::set_msg(for_input ? "The area contains nothing." : "The pattern dies out.");
             return {};
         } else if (!(range.begin.both_gteq(period_size) && range.end.both_lteq(tile.size - period_size))) {
             if (for_input) {
-                messenger::set_msg("The area should fully enclose the pattern with 2*2 periodic background.");
+                messenger::set_msg("The area should fully enclose the pattern with periodic background.");
             } else {
                 assert(false); // Guaranteed by `regionT::run`.
             }
@@ -213,27 +329,75 @@ static void identify(const aniso::tile_const_ref tile, const aniso::ruleT& rule,
         }
         return aniso::rangeT{.begin = range.begin - period_size, .end = range.end + period_size};
     };
+    // The buffers only grow (each axis to at least twice the size), so the steps don't allocate after a few
+    // generations. (The ones that have grown large are released after the run.)
+    static constexpr int max_kept_area = 1024 * 1024;
+    struct bufferT {
+        aniso::tileT tile{};
+
+        aniso::tile_ref reserve(const aniso::vecT size) {
+            const aniso::vecT cap = tile.size();
+            if (!size.both_lteq(cap)) {
+                tile.resize({.x = size.x > cap.x ? std::max(size.x, cap.x * 2) : cap.x,
+                             .y = size.y > cap.y ? std::max(size.y, cap.y * 2) : cap.y});
+            }
+            return tile.data().clip({{0, 0}, size});
+        }
+
+        void release_large() {
+            if (tile.size().xy() > max_kept_area) {
+                tile = aniso::tileT{};
+            }
+        }
+    };
     struct regionT {
-        aniso::tileT tile;
-        aniso::rangeT range; // Range of pattern (including the background border), relative to the tile.
+        bufferT buf, next;   // Ping-pong buffers.
+        aniso::rangeT range; // Range of pattern (including the background border), relative to `buf`.
         aniso::vecT off;     // Pattern's begin pos, relative to the initial pattern.
+        aniso::vecT period_size{};
+        aniso::tileT aligned{}; // The background aligned to `next` (of `period_size`).
+
+        // Scratch for `apply_rule` (for the capacity of `scratch_size`).
+        aniso::vecT scratch_size{};
+        std::unique_ptr<bool[]> border_data{};
+        std::unique_ptr<char[]> vec_p6{};
+
+        aniso::tile_const_ref pattern() const { return buf.tile.data().clip(range); }
+
+        void release_large() {
+            buf.release_large();
+            next.release_large();
+            if (scratch_size.xy() > max_kept_area) {
+                scratch_size = {};
+                border_data.reset();
+                vec_p6.reset();
+            }
+        }
+
         bool run(const aniso::ruleT& rule) {
-            const aniso::tile_const_ref pattern = tile.data().clip(range);
+            const aniso::tile_const_ref pattern = this->pattern();
             const aniso::tile_const_ref background = pattern.clip({{0, 0}, period_size});
             const aniso::vecT padding = {1, 1};
             // (Ceiled for torus run. This can be avoided if `border_ref` is calculated manually, but that
             // will be a lot of code.)
-            aniso::tileT next(aniso::divmul_ceil(range.size() + padding * 2, period_size));
+            const aniso::vecT size = aniso::divmul_ceil(range.size() + padding * 2, period_size);
+            const aniso::tile_ref dest = next.reserve(size);
+            if (!size.both_lteq(scratch_size)) {
+                scratch_size = aniso::max(size, scratch_size * 2);
+                border_data = std::make_unique_for_overwrite<bool[]>(aniso::calc_border_size(scratch_size));
+                vec_p6 = std::make_unique_for_overwrite<char[]>(scratch_size.x);
+            }
 
-            periodT aligned{}; // Aligned to next.data().at(0, 0).
             aniso::rotate_copy_00_to(aligned.data(), background, padding);
             const aniso::rangeT relocate{.begin = padding, .end = padding + pattern.size};
-            aniso::fill_outside(next.data(), relocate, aligned.data());
-            aniso::copy(next.data().clip(relocate), pattern);
-            next.run_torus(rule);
-
-            tile.swap(next);
-            if (const auto next_range = locate_pattern(tile.data())) {
+            aniso::fill_outside(dest, relocate, aligned.data());
+            aniso::copy(dest.clip(relocate), pattern);
+            const aniso::border_ref border{.size = size, .data = border_data.get()};
+            border.collect_from(dest, dest, dest, dest, dest, dest, dest, dest);
+            aniso::apply_rule(rule, dest, dest, border, vec_p6.get());
+
+            std::swap(buf, next);
+            if (const auto next_range = locate_pattern(dest, period_size)) {
                 off = off - padding + next_range->begin;
                 range = *next_range;
                 return true;
@@ -242,55 +406,139 @@ static void identify(const aniso::tile_const_ref tile, const aniso::ruleT& rule,
         }
     };
 
+    const std::optional<aniso::vecT> period_opt = aniso::border_period(tile, max_period_size);
+    if (!period_opt) {
+        messenger::set_msg("The area should fully enclose the pattern with periodic background. (The spatial "
+                           "period should be at most 4*4.)");
+        return;
+    }
+    const aniso::vecT period_size = *period_opt;
     if (!tile.size.both_gt(period_size * 2)) {
-        messenger::set_msg("The area is too small. (Should be larger than 4*4.)");
+        messenger::set_msg("The area is too small. (Should be larger than {}*{}.)", period_size.x * 2,
+                           period_size.y * 2);
         return;
     }
 
-    const periodT init_background = take_corner(tile);
-    const std::optional<aniso::rangeT> init_range = locate_pattern(tile, true);
+    const aniso::tileT init_background(tile.clip({{0, 0}, period_size}));
+    const std::optional<aniso::rangeT> init_range = locate_pattern(tile, period_size, true);
     if (!init_range) {
         return;
-    } else if (!init_background.is_periodic(rule)) {
+    } else if (!is_periodic(init_background.data(), rule)) {
         messenger::set_msg("The background is not temporally periodic.");
         return;
     }
 
+    // The phases of the background that match the initial one (with any alignment).
+    std::vector<aniso::tileT> matching_backgrounds;
+    for (int dy = 0; dy < period_size.y; ++dy) {
+        for (int dx = 0; dx < period_size.x; ++dx) {
+            aniso::tileT& ro = matching_backgrounds.emplace_back(period_size);
+            aniso::rotate_copy_00_to(ro.data(), init_background.data(), {.x = dx, .y = dy});
+        }
+    }
+    const auto matches_background = [&](const aniso::tile_const_ref pattern) {
+        return std::ranges::any_of(matching_backgrounds, [&](const aniso::tileT& background) {
+            return aniso::equal(background.data(), pattern.clip({{0, 0}, period_size}));
+        });
+    };
+
     const aniso::tile_const_ref init_pattern = tile.clip(*init_range);
-    regionT region{.tile = aniso::tileT(init_pattern), .range = {{0, 0}, init_pattern.size}, .off = {0, 0}};
-    aniso::tileT smallest = region.tile;
+    static regionT region{}; // (Reused by later calls.)
+    aniso::copy(region.buf.reserve(init_pattern.size), init_pattern);
+    region.range = {{0, 0}, init_pattern.size};
+    region.off = {0, 0};
+    if (region.period_size != period_size) {
+        region.period_size = period_size;
+        region.aligned = aniso::tileT(period_size);
+    }
 
-    const int limit = 4000; // Max period to deal with.
+    // Brent's cycle detection: the pattern is compared with the one saved at the last power of 2 (by the hash
+    // first), so the cycle is found in at most (transient + 2 * period) generations, from any phase (so the area
+    // can also contain something that evolves to the object).
+    // (The pattern includes the background border, so the phase of the background is compared as well.)
+    static bufferT saved{};
+    aniso::vecT saved_size{}, saved_off{};
+    uint64_t saved_hash = 0;
+    const auto save = [&] {
+        const aniso::tile_const_ref pattern = region.pattern();
+        aniso::copy(saved.reserve(pattern.size), pattern);
+        saved_size = pattern.size;
+        saved_off = region.off;
+        saved_hash = hash_tile(pattern);
+    };
+    const auto matches_saved = [&] {
+        const aniso::tile_const_ref pattern = region.pattern();
+        return pattern.size == saved_size && hash_tile(pattern) == saved_hash &&
+               aniso::equal(pattern, saved.tile.data().clip({{0, 0}, saved_size}));
+    };
+    struct releaseT {
+        ~releaseT() {
+            region.release_large();
+            saved.release_large();
+        }
+    } const release{};
+
+    save();
+    // Max generations to run, and max cells to calculate in all generations. (The latter is the cost of 4000
+    // generations of the largest pattern, so that the run stays interactive even if the pattern keeps growing,
+    // like guns or puffers.)
+    const int limit = 300000;
+    const int64_t max_cost = int64_t(4000) * 400 * 400;
+    int64_t cost = 0;
+    int power = 1, period = 0;
     for (int g = 1; g <= limit; ++g) {
         if (!region.run(rule)) {
             return;
         }
+        ++period;
+        cost += region.range.size().xy();
+        if (matches_saved()) {
+            break;
+        } else if (g == limit || cost > max_cost) {
+            // For example, this can happen the object really has a huge period, or the initial area doesn't
+            // contain a full phase (most fragments evolve to non-periodic things), or whatever else.
+            messenger::set_msg("Cannot identify.");
+            return;
+        } else if (period == power) {
+            save();
+            power *= 2;
+            period = 0;
+        }
+    }
 
-        const aniso::tile_const_ref pattern = region.tile.data().clip(region.range);
-        if ((!require_matching_background || init_background.rotate_equal(take_corner(pattern))) &&
-            pattern.size.xy() < smallest.size().xy()) {
-            smallest = aniso::tileT(pattern);
+    // The current pattern is in the cycle; go through a full period to find the smallest phase.
+    const aniso::vecT offset = region.off - saved_off;
+    std::optional<aniso::tileT> smallest{};
+    for (int g = 0; g < period; ++g) {
+        const aniso::tile_const_ref pattern = region.pattern();
+        if ((!require_matching_background || matches_background(pattern)) &&
+            (!smallest || pattern.size.xy() < smallest->size().xy())) {
+            smallest.emplace(pattern);
         }
-        if (aniso::equal(init_pattern, pattern)) {
-            std::string str;
-            const bool is_oscillator = region.off == aniso::vecT{0, 0};
-            if (is_oscillator && g == 1) {
-                str = "#C Still life.\n";
-            } else if (is_oscillator) {
-                str = std::format("#C Oscillator. Period:{}.\n", g);
-            } else {
-                str = std::format("#C Spaceship. Period:{}. Offset(x,y):({},{}).\n", g, region.off.x, region.off.y);
-            }
-            assert(str.ends_with('\n'));
-            str += aniso::to_RLE_str(smallest.data(), &rule);
-            ImGui::SetClipboardText(str.c_str());
-            messenger::set_msg(std::move(str));
+        if (!region.run(rule)) {
+            assert(false);
             return;
         }
     }
-    // For example, this can happen the object really has a huge period, or the initial area doesn't
-    // contain a full phase (fragments that evolves to full objects are not recognized), or whatever else.
-    messenger::set_msg("Cannot identify.");
+    if (!smallest) {
+        // (The background may have changed to a different phase in the transient generations.)
+        messenger::set_msg("Cannot identify.");
+        return;
+    }
+
+    std::string str;
+    const bool is_oscillator = offset == aniso::vecT{0, 0};
+    if (is_oscillator && period == 1) {
+        str = "#C Still life.\n";
+    } else if (is_oscillator) {
+        str = std::format("#C Oscillator. Period:{}.\n", period);
+    } else {
+        str = std::format("#C Spaceship. Period:{}. Offset(x,y):({},{}).\n", period, offset.x, offset.y);
+    }
+    assert(str.ends_with('\n'));
+    str += aniso::to_RLE_str(smallest->data(), &rule);
+    ImGui::SetClipboardText(str.c_str());
+    messenger::set_msg(std::move(str));
 }
 
 class percentT {
@@ -355,9 +603,11 @@ class zoomT {
         float val;
         const char* str;
     };
-    static constexpr termT terms[]{{0.5, "0.5"}, {1, "1"}, {2, "2"}, {3, "3"}, {4, "4"}, {5, "5"}};
+    // (The zooms below 1 are shown by the density of the cells; see `make_density_screen`.)
+    static constexpr termT terms[]{{0.125, "1/8"}, {0.25, "1/4"}, {0.5, "0.5"}, {1, "1"},
+                                   {2, "2"},       {3, "3"},      {4, "4"},     {5, "5"}};
 
-    static constexpr int index_1 = 1;
+    static constexpr int index_1 = 3;
     static constexpr int index_max = std::size(terms) - 1; // ]
     int m_index = index_1;
 
@@ -380,6 +630,8 @@ public:
 
     static constexpr float min() { return terms[0].val; }
     static constexpr float max() { return terms[index_max].val; }
+    // 1 / zoom for the zooms below 1, or 1 otherwise.
+    int density_block() const { return terms[m_index].val < 1 ? int(1 / terms[m_index].val) : 1; }
     operator float() const {
         assert(m_index >= 0 && m_index <= index_max);
         return terms[m_index].val;
@@ -401,34 +653,380 @@ class runnerT {
         bool pause = false;
         int extra_step = 0;
         global_timer::timerT timer{init_zero_interval ? 0 : global_timer::min_nonzero_interval};
+        bool max_speed = false; // Run every frame, as many generations as fit in `budget_ms`.
+    };
+
+    // (For plane mode) how the view sent with the state applies to the plane.
+    struct plane_stateT {
+        std::optional<aniso::tileT> reset; // The background to reset the plane with (before writing).
+        std::optional<aniso::tileT> base;  // What the view is edited from; if present, only the edited cells are
+                                           // written, so the rest of the view keeps the newer generation.
+        bool write;
+        aniso::vecT origin, view; // Where the view is written, and where the snapshots are taken.
+    };
+
+    static constexpr int max_jump = 20; // (2^max_jump generations.)
+
+    // Stepping state, owned by the simulation thread.
+    class engineT {
+        // The packed tile is run by the family kernel for totalistic rules, by the circuit if the network is small
+        // (or for any rule if the circuit is compiled), or else by the 2x2-block table, which outperforms the
+        // per-cell lookup only for large tiles.
+        static constexpr int circuit_threshold = 50;
+        static constexpr int compiled_circuit_threshold = 250; // (Random rules take ~220 gates.)
+        static constexpr int block_table_min_area = 200 * 200;
+        aniso::ruleT m_rule{};
+        aniso::circuitT m_circuit{m_rule};
+        std::optional<aniso::family_kernelT> m_family_kernel{}; // For rules in the families.
+        std::optional<aniso::block_tableT> m_block_table{};     // Built when first needed.
+        aniso::jit_cacheT m_jit_cache{};
+        bool m_compiled = false; // Whether the circuit in use is compiled.
+        aniso::packed_tileT m_packed{}, m_packed_temp{};
+        aniso::worker_poolT m_pool{};
+        aniso::banded_stepperT m_stepper{}; // (Keeps the scratch of the packed kernels.)
+
+        // The active-region stepper wins when most of the space is quiescent. While the packed tile is in use,
+        // the activity is re-measured every 256 generations.
+        aniso::active_stepperT m_active{};
+        bool m_use_packed = true;
+        int m_packed_gens = 0;
+
+        // In plane mode, `tile` is the view of the plane at `m_view`.
+        std::optional<aniso::sparse_planeT> m_plane{};
+        aniso::vecT m_view{};
+        aniso::tileT m_plane_temp{};
+
+        // (Plane mode) kept for the jumps, so that the memoized results are reused by later jumps (for the same
+        // rule). `m_life_synced` ~ `m_life` has the same plane as `m_plane` (i.e. it was not run or edited since
+        // the last jump).
+        std::optional<aniso::hashlifeT> m_life{};
+        bool m_life_synced = false;
+
+    public:
+        aniso::tileT tile{};
+        int64_t gen = 0;
+
+        // (Should be called after `tile` is set to the view; empty `state` ~ torus mode.)
+        void set_plane(std::optional<plane_stateT>&& state) {
+            if (!state) {
+                m_plane.reset();
+                m_life.reset();
+                return;
+            }
+            if (!m_plane || state->reset || state->write) {
+                m_life_synced = false;
+            }
+            if (!m_plane || state->reset) {
+                m_plane.emplace();
+                m_plane->set_plane(state->reset ? state->reset->data() : aniso::tileT({1, 1}).data());
+            }
+            if (state->write && state->base) {
+                m_plane_temp.resize(tile.size());
+                m_plane->read(m_plane_temp.data(), state->origin);
+                aniso::copy_diff(m_plane_temp.data(), tile.data(), state->base->data());
+                m_plane->write(m_plane_temp.data(), state->origin);
+            } else if (state->write) {
+                m_plane->write(tile.data(), state->origin);
+            }
+            m_view = state->view;
+            m_plane->read(tile.data(), m_view);
+        }
+
+        bool in_plane() const { return m_plane.has_value(); }
+        aniso::vecT view() const { return m_view; }
+        int chunk_count() const { return m_plane ? m_plane->chunk_count() : 0; }
+
+        // (`circuit` is the circuit for `rule` if available.)
+        void set_state(const aniso::ruleT& rule, std::optional<aniso::circuitT>&& circuit) {
+            if (circuit) {
+                m_circuit = std::move(*circuit);
+            } else if (m_rule != rule) {
+                m_circuit = aniso::circuitT(rule);
+            }
+            if (m_rule != rule) {
+                m_block_table.reset();
+                m_family_kernel.reset();
+                m_life.reset();
+                if (aniso::family_kernelT::detect(rule) != aniso::family_kernelT::familyE::Any) {
+                    m_family_kernel.emplace(rule);
+                }
+            }
+            aniso::circuitT& in_use = m_family_kernel ? m_family_kernel->circuit() : m_circuit;
+            auto runner = m_jit_cache.get(rule, in_use);
+            m_compiled = runner != nullptr;
+            in_use.set_runner(std::move(runner));
+            m_rule = rule;
+            m_active.reset();
+        }
+
+        // (Plane mode only) advance the plane by 2^j generations at once by HashLife.
+        // Returns false (with the plane unchanged) if the pattern would go beyond the range of the plane.
+        bool jump(const int j) {
+            assert(m_plane && j >= 0 && j <= max_jump);
+            if (!m_life) {
+                m_life.emplace(m_rule);
+            }
+            if (!m_life_synced) {
+                m_life->clear(m_plane->background());
+                m_plane->for_each_stored_chunk([&](const aniso::vecT begin, const aniso::tile_const_ref chunk) {
+                    m_life->write(chunk, {begin.x, begin.y});
+                });
+            }
+            m_life->run(uint64_t(1) << j);
+
+            // (The positions are checked before narrowing to int, with a margin for the chunks and the view.)
+            if (!m_life->is_within(int64_t(1) << 30)) {
+                m_life_synced = false;
+                return false;
+            }
+            m_plane->set_plane(m_life->background());
+            m_life->for_each_area(6, [&](const aniso::hashlifeT::posT begin, const aniso::tile_const_ref area) {
+                m_plane->write(area, {.x = int(begin.x), .y = int(begin.y)});
+            });
+            m_life_synced = true;
+            gen += int64_t(1) << j;
+            m_plane->read(tile.data(), m_view);
+            return true;
+        }
+
+        void run(const int count) {
+            if (m_plane) {
+                m_plane->run(m_rule, m_pool, count);
+                m_life_synced = false;
+                gen += count;
+                m_plane->read(tile.data(), m_view);
+                return;
+            }
+
+            const bool use_family = m_family_kernel.has_value();
+            const bool use_circuit =
+                !use_family &&
+                m_circuit.gate_count() <= (m_compiled ? compiled_circuit_threshold : circuit_threshold);
+            const bool packed_ok = use_family || use_circuit || tile.size().xy() >= block_table_min_area;
+            if (packed_ok && m_use_packed) {
+                if (m_packed.size() != tile.size()) {
+                    m_packed.resize(tile.size());
+                    m_packed_temp.resize(tile.size());
+                }
+                if (!use_family && !use_circuit && !m_block_table) {
+                    m_block_table.emplace(m_rule);
+                }
+                aniso::copy(m_packed, tile.data());
+                for (int c = 0; c < count;) {
+                    if (use_family) {
+                        m_stepper.run(*m_family_kernel, m_pool, m_packed_temp, m_packed);
+                        ++c;
+                    } else if (use_circuit) {
+                        m_stepper.run(m_circuit, m_pool, m_packed_temp, m_packed);
+                        ++c;
+                    } else if (count - c >= 2) { // (Always the case for strobing rules.)
+                        m_stepper.run_2(*m_block_table, m_pool, m_packed_temp, m_packed);
+                        c += 2;
+                    } else {
+                        m_stepper.run(*m_block_table, m_pool, m_packed_temp, m_packed);
+                        ++c;
+                    }
+                    m_packed.swap(m_packed_temp);
+                }
+                gen += count;
+                aniso::copy(tile.data(), m_packed);
+                m_active.reset();
+                m_packed_gens += count;
+                if (m_packed_gens >= 256) {
+                    m_use_packed = false;
+                }
+                return;
+            }
+
+            for (int c = 0; c < count; ++c) {
+                m_active.step(m_rule, m_pool, tile);
+                ++gen;
+            }
+            if (packed_ok && m_active.measured()) {
+                m_use_packed = m_active.active_ratio() > 0.25;
+                m_packed_gens = 0;
+            }
+        }
     };
 
     // TODO: ideally the space window should skip the initial state as well (if not paused).
     // (This change is not as easy to make as it seems, as the current impl is toooo fragile...)
+    // The torus is run in a separate thread. `m_torus` is the latest snapshot, which is read and modified by the
+    // UI thread only; modified states are sent back to the simulation thread in `end_frame`.
     class torusT {
         initT m_init{.seed = 0, .density = 0.5, .area = 0.5, .background = aniso::tileT{{.x = 1, .y = 1}}};
         aniso::tileT m_torus{{.x = 600, .y = 400}};
         ctrlT m_ctrl{.rule{}, .step = 1, .pause = false};
-        int m_gen = 0;
+        int64_t m_gen = 0;
+        int m_gate_count = 0;
 
         bool extra_pause = false;
         bool skip_next = false;
 
         bool m_resized = true; // Init ~ resized.
 
+        bool m_modified = false;                    // `m_torus` should be sent in `end_frame`.
+        std::optional<aniso::circuitT> m_circuit{}; // To be sent with the next state.
+        int m_epoch = 0;                            // Increased for each sent state.
+
+        // In plane mode, `m_torus` is the view of the unbounded plane at `m_tile_view`, and the plane outside of
+        // it is kept by the simulation thread only.
+        bool m_plane_mode = false;
+        aniso::vecT m_view{}, m_tile_view{}; // Requested by the UI, and where `m_torus` is taken.
+        aniso::tileT m_base{};               // The view before the edits, to find the edited cells.
+        bool m_view_moved = false, m_reset_plane = false;
+        int m_jump = -1; // To be sent in `end_frame`.
+        int m_chunk_count = 0;
+
+        using clockT = std::chrono::steady_clock;
+        clockT::time_point m_rate_time = clockT::now();
+        int64_t m_rate_gen = 0;
+        int m_gens_per_sec = 0;
+
+        // Triple buffer; the snapshots with old `epoch` are dropped.
+        struct snapshotT {
+            aniso::tileT tile{};
+            int64_t gen = 0;
+            int epoch = 0;
+            aniso::vecT view{};
+            int chunk_count = 0;
+            bool jump_refused = false;
+        };
+        static constexpr int fresh_bit = 4;
+        snapshotT m_snapshots[3]{};
+        std::atomic_int m_middle{1}; // Index (| fresh_bit if not taken yet).
+        int m_front = 0;             // Owned by the UI thread.
+
+        // Commands, guarded by `m_mut`.
+        std::mutex m_mut{};
+        std::condition_variable m_cond{};
+        struct stateT {
+            aniso::tileT tile;
+            int64_t gen;
+            int epoch;
+            aniso::ruleT rule;
+            std::optional<aniso::circuitT> circuit;
+            std::optional<plane_stateT> plane; // (Empty ~ torus mode.)
+        };
+        std::optional<stateT> m_cmd_state{};
+        int m_cmd_count = 0;
+        int m_cmd_jump = -1; // (Plane mode) 2^j generations to jump (-1 ~ none).
+        bool m_cmd_stop = false;
+
+        std::atomic<double> m_ms_per_gen{0.1}; // Measured by the simulation thread.
+
+        std::thread m_thread{}; // (Started after all the other members are initialized.)
+
+        void sim_loop() {
+            engineT engine{};
+            int epoch = 0;
+            int back = 2;
+            for (;;) {
+                int count = 0, jump = -1;
+                bool publish = false; // (Plane mode) the view may be moved, or the plane jumped.
+                bool jump_refused = false;
+                {
+                    std::unique_lock lock(m_mut);
+                    m_cond.wait(lock,
+                                [&] { return m_cmd_stop || m_cmd_state || m_cmd_count > 0 || m_cmd_jump >= 0; });
+                    if (m_cmd_stop) {
+                        return;
+                    }
+                    if (m_cmd_state) {
+                        engine.tile.swap(m_cmd_state->tile);
+                        if (!m_cmd_state->plane || m_cmd_state->plane->reset) {
+                            engine.gen = m_cmd_state->gen;
+                        }
+                        engine.set_state(m_cmd_state->rule, std::move(m_cmd_state->circuit));
+                        engine.set_plane(std::move(m_cmd_state->plane));
+                        publish = engine.in_plane();
+                        epoch = m_cmd_state->epoch;
+                        m_cmd_state.reset();
+                    }
+                    count = std::exchange(m_cmd_count, 0);
+                    jump = std::exchange(m_cmd_jump, -1);
+                }
+
+                if (jump >= 0 && engine.in_plane()) {
+                    jump_refused = !engine.jump(jump);
+                    publish = true;
+                }
+
+                if (count > 0) {
+                    const auto start = std::chrono::steady_clock::now();
+                    engine.run(count);
+                    double ms_per_gen = m_ms_per_gen.load(std::memory_order_relaxed);
+                    update_cost(ms_per_gen, count,
+                                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                                    .count());
+                    m_ms_per_gen.store(ms_per_gen, std::memory_order_relaxed);
+                }
+                if (count > 0 || publish) {
+                    snapshotT& snapshot = m_snapshots[back];
+                    snapshot.tile.resize(engine.tile.size());
+                    aniso::copy(snapshot.tile.data(), engine.tile.data());
+                    snapshot.gen = engine.gen;
+                    snapshot.epoch = epoch;
+                    snapshot.view = engine.view();
+                    snapshot.chunk_count = engine.chunk_count();
+                    snapshot.jump_refused = jump_refused;
+                    back = m_middle.exchange(back | fresh_bit) & ~fresh_bit;
+                }
+            }
+        }
+
     public:
         torusT() {
             assert(m_torus.size() == calc_size(m_torus.size()));
             restart();
+            m_thread = std::thread([this] { sim_loop(); });
+        }
+
+        ~torusT() {
+            {
+                std::unique_lock lock(m_mut);
+                m_cmd_stop = true;
+            }
+            m_cond.notify_one();
+            m_thread.join();
         }
 
         bool begin_frame(const aniso::ruleT& rule) {
             extra_pause = false;
             m_ctrl.extra_step = 0;
 
+            if (m_middle.load() & fresh_bit) {
+                m_front = m_middle.exchange(m_front) & ~fresh_bit;
+                snapshotT& snapshot = m_snapshots[m_front];
+                if (snapshot.epoch == m_epoch) {
+                    assert(snapshot.tile.size() == m_torus.size());
+                    m_torus.swap(snapshot.tile);
+                    m_gen = snapshot.gen;
+                    m_tile_view = snapshot.view;
+                    m_chunk_count = snapshot.chunk_count;
+                    if (snapshot.jump_refused) {
+                        messenger::set_msg("The pattern would go too far from the origin. (The jump is canceled.)");
+                    }
+                    if (m_plane_mode) {
+                        m_base.resize(m_torus.size());
+                        aniso::copy(m_base.data(), m_torus.data());
+                    }
+                }
+            }
+
+            const clockT::time_point now = clockT::now();
+            if (now - m_rate_time >= std::chrono::seconds(1)) {
+                const double secs = std::chrono::duration<double>(now - m_rate_time).count();
+                m_gens_per_sec = std::max(int64_t(0), m_gen - m_rate_gen) / secs;
+                m_rate_time = now;
+                m_rate_gen = m_gen;
+            }
+
             if (m_ctrl.rule != rule) {
                 m_ctrl.rule = rule;
                 m_ctrl.pause = false;
+                m_circuit.emplace(rule);
+                m_gate_count = m_circuit->gate_count();
 
                 restart();
                 return true;
@@ -437,8 +1035,13 @@ class runnerT {
         }
         void restart() {
             m_gen = 0;
+            m_rate_gen = 0;
             m_init.initialize(m_torus);
             skip_next = true;
+            m_modified = true;
+            m_view = m_tile_view = {0, 0}; // (So that the view is aligned with the background.)
+            m_reset_plane = true;
+            m_chunk_count = 0;
         }
         void pause_for_this_frame() { extra_pause = true; }
         void skip_next_run() { skip_next = true; }
@@ -448,29 +1051,53 @@ class runnerT {
 
         aniso::tile_ref write_only() {
             skip_next = true;
+            m_modified = true;
             return m_torus.data();
         }
         aniso::tile_ref write_only(const aniso::rangeT& range) {
             skip_next = true;
+            m_modified = true;
             return m_torus.data().clip(range);
         }
 
         void read_and_maybe_write(const std::invocable<aniso::tile_ref> auto& fn) {
             if (fn(m_torus.data())) {
                 skip_next = true;
+                m_modified = true;
             }
         }
 
+        // (In plane mode, the view is moved instead, and `m_torus` is updated by the next snapshot.)
         void rotate_00_to(int dx, int dy) {
-            if (dx != 0 || dy != 0) {
+            if (m_plane_mode) {
+                m_view = m_view - aniso::vecT{.x = dx, .y = dy};
+                m_view_moved = m_view_moved || dx != 0 || dy != 0;
+            } else if (dx != 0 || dy != 0) {
                 aniso::tileT temp(m_torus.size());
                 aniso::rotate_copy_00_to(temp.data(), m_torus.data(), {.x = dx, .y = dy});
                 m_torus.swap(temp);
+                m_modified = true;
             }
         }
 
         // int area() const { return m_torus.size().xy(); }
-        int gen() const { return m_gen; }
+        int64_t gen() const { return m_gen; }
+        int gens_per_sec() const { return m_gens_per_sec; }
+        int gate_count() const { return m_gate_count; }
+        int chunk_count() const { return m_chunk_count; }
+
+        bool plane_mode() const { return m_plane_mode; }
+        // (Plane mode) advance 2^j generations at once.
+        void jump(const int j) {
+            assert(m_plane_mode && j >= 0 && j <= max_jump);
+            m_jump = j;
+        }
+        void set_plane_mode(const bool plane) {
+            if (m_plane_mode != plane) {
+                m_plane_mode = plane;
+                restart();
+            }
+        }
         aniso::vecT size() const {
             assert(m_torus.size() == calc_size(m_torus.size()));
             return m_torus.size();
@@ -514,6 +1141,43 @@ class runnerT {
         }
 
         void end_frame() {
+            if (m_modified || m_view_moved) {
+                std::optional<plane_stateT> plane{};
+                if (m_plane_mode) {
+                    plane.emplace(plane_stateT{
+                        .reset{}, .base{}, .write = m_modified, .origin = m_tile_view, .view = m_view});
+                    if (m_reset_plane) {
+                        plane->reset.emplace(m_init.background);
+                    } else if (m_modified) {
+                        plane->base.emplace(m_base);
+                    }
+                    m_base.resize(m_torus.size()); // (The sent view is the new base.)
+                    aniso::copy(m_base.data(), m_torus.data());
+                }
+                {
+                    std::unique_lock lock(m_mut);
+                    m_cmd_state = stateT{.tile = aniso::tileT(m_torus),
+                                         .gen = m_gen,
+                                         .epoch = ++m_epoch,
+                                         .rule = m_ctrl.rule,
+                                         .circuit = std::move(m_circuit),
+                                         .plane = std::move(plane)};
+                    m_cmd_count = 0; // (For the old state.)
+                }
+                m_modified = m_view_moved = m_reset_plane = false;
+                m_circuit.reset();
+                m_cond.notify_one();
+            }
+
+            if (m_jump >= 0) {
+                {
+                    std::unique_lock lock(m_mut);
+                    m_cmd_jump = m_jump;
+                }
+                m_jump = -1;
+                m_cond.notify_one();
+            }
+
             if (skip_next) {
                 // Intentionally not affected by (extra_)pause.
                 if (m_ctrl.extra_step || m_ctrl.timer.test()) {
@@ -523,12 +1187,19 @@ class runnerT {
             }
 
             int count = m_ctrl.extra_step;
-            if (count == 0 && !m_ctrl.pause && !extra_pause && m_ctrl.timer.test()) {
-                count = m_ctrl.actual_step();
+            if (count == 0 && !m_ctrl.pause && !extra_pause && (m_ctrl.max_speed || m_ctrl.timer.test())) {
+                count = m_ctrl.max_speed
+                            ? adjust_step(budget_step(m_ms_per_gen.load(std::memory_order_relaxed)), m_ctrl.rule)
+                            : m_ctrl.actual_step();
             }
-            for (int c = 0; c < count; ++c) {
-                m_torus.run_torus(m_ctrl.rule);
-                ++m_gen;
+            if (count != 0) {
+                {
+                    // Manual steps are accumulated. Otherwise, if the simulation thread cannot keep up, the
+                    // requests are merged, so the UI never waits for the simulation.
+                    std::unique_lock lock(m_mut);
+                    m_cmd_count = m_ctrl.extra_step ? m_cmd_count + count : std::max(m_cmd_count, count);
+                }
+                m_cond.notify_one();
             }
         }
     };
@@ -835,9 +1506,11 @@ public:
             }
 
             // TODO: recheck this design... Ideally these sliders should use locally-defined `item_shortcut`.
+            ImGui::BeginDisabled(ctrl.max_speed);
             imgui_StepSliderShortcuts::set(ImGuiKey_1, ImGuiKey_2, enable_shortcuts);
             imgui_StepSliderInt("Step", &ctrl.step, ctrl.step_min, ctrl.step_max, step_str.c_str());
             imgui_StepSliderShortcuts::reset();
+            ImGui::EndDisabled();
             ImGui::SameLine();
             imgui_StrTooltip(
                 "(?)",
@@ -845,10 +1518,17 @@ public:
                 "In such cases, the step will be shown as e.g. '1 -> 2', '2 -> 2', '3 -> 4', '4 -> 4'. The adjustment also applies to '+s' mode, but you can still change the parity of generation with the '+1' button.\n\n"
                 "Occasionally, you may also find rules that don't flash in the pure-color case (so the adjustment won't happen), but can develop non-trivial flashing areas. The effect can usually be avoided by manually setting an even step.");
 
+            ImGui::BeginDisabled(ctrl.max_speed);
             const int min_ms = 0, max_ms = 400;
             imgui_StepSliderShortcuts::set(ImGuiKey_3, ImGuiKey_4, enable_shortcuts);
             ctrl.timer.slide_interval("Interval", min_ms, max_ms);
             imgui_StepSliderShortcuts::reset();
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::Checkbox("Max", &ctrl.max_speed);
+            guide_mode::item_tooltip(
+                std::format("Run as many generations as fit in {} ms in every frame (instead of step/interval).",
+                            budget_ms));
         });
         ImGui::EndGroup();
         ImGui::SameLine(floor(1.5 * item_width));
@@ -877,7 +1557,7 @@ public:
                                       "- Scroll in the window to zoom in/out.\n\n"
                                       "When there is no pattern to paste:\n"
                                       "- Drag with left button to move the window.\n"
-                                      "- 'Ctrl' and drag to \"rotate\" the space.\n"
+                                      "- 'Ctrl' and drag to \"rotate\" the space (or move the view in plane mode).\n"
                                       "- Drag with right button to select area.\n"
                                       "- (The selection can be cleared with a single right-click.)\n\n"
                                       "When there is pattern to paste:\n"
@@ -894,6 +1574,32 @@ public:
         }
         guide_mode::item_tooltip("Center the window and select suitable zoom for it.");
 
+        ImGui::SameLine();
+        if (bool plane = m_torus.plane_mode(); ImGui::Checkbox("Plane", &plane)) {
+            m_torus.set_plane_mode(plane);
+        }
+        guide_mode::item_tooltip("Run the unbounded plane instead of the torus. The space shows a view of the plane, "
+                                 "and 'Ctrl' + drag moves the view.\n\n"
+                                 "(The space will restart. The plane is stored in chunks, which are allocated only "
+                                 "where the pattern differs from the background.)");
+        if (m_torus.plane_mode()) {
+            ImGui::SameLine();
+            ImGui::Button("Jump");
+            if (begin_popup_for_item()) {
+                static int jump = 10;
+                ImGui::SetNextItemWidth(item_width);
+                ImGui::SliderInt("##Gens", &jump, 1, max_jump, "2^%d gens", ImGuiSliderFlags_AlwaysClamp);
+                ImGui::SameLine();
+                if (ImGui::Button("Run")) {
+                    m_torus.jump(jump);
+                }
+                ImGui::SameLine();
+                imgui_StrTooltip("(?)", "Advance the plane by 2^n generations at once, by HashLife (which is fast "
+                                        "for regular patterns, but not for chaotic ones).");
+                ImGui::EndPopup();
+            }
+        }
+
         ImGui::SameLine();
         static bool show_range_window = false;
         ImGui::Checkbox("Range ops", &show_range_window);
@@ -907,7 +1613,15 @@ public:
 
         const int wide_spacing = ImGui::CalcTextSize(" ").x * 2;
         ImGui::SameLine(0, wide_spacing);
-        ImGui::Text("Generation:%d", m_torus.gen());
+        ImGui::Text("Generation:%lld", (long long)m_torus.gen());
+        ImGui::SameLine(0, wide_spacing);
+        ImGui::Text("Gen/s:%d (FPS:%.0f)", m_torus.gens_per_sec(), ImGui::GetIO().Framerate);
+        ImGui::SameLine(0, wide_spacing);
+        ImGui::Text("Gates:%d", m_torus.gate_count());
+        if (m_torus.plane_mode()) {
+            ImGui::SameLine(0, wide_spacing);
+            ImGui::Text("Chunks:%d", m_torus.chunk_count());
+        }
 
         ImGui::SameLine(0, wide_spacing);
         if (m_sel) {
@@ -1062,11 +1776,30 @@ public:
                 drawlist->PushClipRect(canvas_min, canvas_max);
                 drawlist->AddRectFilled(canvas_min, canvas_max, IM_COL32_GREY(24, 255));
 
-                const scaleE scale_mode = m_coord.zoom < 1 ? scaleE::Linear : scaleE::Nearest;
+                // Only the visible part of the space is converted and uploaded, so the cost scales with the
+                // canvas instead of the space. (The range is snapped to blocks, so that the texture is not
+                // resized in every frame when the window is moved.)
+                const aniso::rangeT visible = [&]() -> aniso::rangeT {
+                    constexpr int snap = 64;
+                    const ImVec2 begin = m_coord.to_space({0, 0}), end = m_coord.to_space(canvas_size);
+                    const auto snap_floor = [](float v) { return int(std::floor(v / snap)) * snap; };
+                    const auto snap_ceil = [](float v) { return int(std::ceil(v / snap)) * snap; };
+                    const aniso::rangeT range{{snap_floor(begin.x), snap_floor(begin.y)},
+                                              {snap_ceil(end.x), snap_ceil(end.y)}};
+                    return aniso::common(range, {{0, 0}, tile_size});
+                }();
+                const ImVec2 visible_min = screen_min + to_imvec(visible.begin) * m_coord.zoom;
+                const ImVec2 visible_max = screen_min + to_imvec(visible.end) * m_coord.zoom;
+
+                const int block = m_coord.zoom.density_block();
+                const auto make_visible_screen = [&](const aniso::tile_const_ref tile) {
+                    return block != 1 ? make_density_screen(tile.clip(visible), block)
+                                      : make_screen(tile.clip(visible), scaleE::Nearest, this);
+                };
                 if (!m_paste) {
-                    const ImTextureID texture = make_screen(m_torus.read_only(), scale_mode);
-
-                    drawlist->AddImage(texture, screen_min, screen_max);
+                    if (!visible.empty()) {
+                        drawlist->AddImage(make_visible_screen(m_torus.read_only()), visible_min, visible_max);
+                    }
                     if (zoom_center.has_value()) {
                         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, {0, 0});
                         if (ImGui::BeginTooltip()) {
@@ -1078,13 +1811,8 @@ public:
                                 // bottom-left corner cannot be fully shown.
                                 hex_image(m_torus.read_only(), *zoom_center, clamped.size() * 3,
                                           std::max(double(m_coord.zoom), 3.0));
-                            } else if (scale_mode == scaleE::Nearest) {
-                                ImGui::Image(texture, to_imvec(clamped.size() * 3),
-                                             to_imvec(clamped.begin) / to_imvec(tile_size),
-                                             to_imvec(clamped.end) / to_imvec(tile_size));
                             } else {
-                                // TODO: is it possible to reuse the texture in a different scale mode?
-                                // (Related: https://github.com/ocornut/imgui/issues/7616)
+                                // (The area may be partly out of the visible range, so it has its own texture.)
                                 ImGui::Image(make_screen(m_torus.read_only(clamped), scaleE::Nearest),
                                              to_imvec(clamped.size() * 3));
                             }
@@ -1118,7 +1846,9 @@ public:
                         // Detect backgrounds of the pattern and the target area (?not practical?).
                         // 'copy_diff' only if the backgrounds are the same and aligns properly.
                         aniso::blit(paste_area, m_paste->data(), paste_mode);
-                        texture = make_screen(tile, scale_mode);
+                        if (!visible.empty()) {
+                            texture = make_visible_screen(tile);
+                        }
                         if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
                             m_paste.reset();
                             return true;
@@ -1129,7 +1859,9 @@ public:
                     });
 
                     // (`paste_beg` and `paste_end` remain valid even if `paste` has been consumed.)
-                    drawlist->AddImage(texture, screen_min, screen_max);
+                    if (texture) {
+                        drawlist->AddImage(texture, visible_min, visible_max);
+                    }
                     const ImVec2 paste_min = screen_min + to_imvec(paste_beg) * m_coord.zoom;
                     const ImVec2 paste_max = screen_min + to_imvec(paste_end) * m_coord.zoom;
                     drawlist->AddRectFilled(paste_min, paste_max, IM_COL32(255, 0, 0, 60));
@@ -1475,6 +2207,32 @@ struct global_config {
     inline static percentT area = 1.0;
 };
 
+class previewer_data {
+    friend class previewer;
+    friend class previewer::configT;
+
+    struct termT {
+        bool active = false;
+        bool skip_run = false;
+        int seed = 0;
+        percentT area = 0;
+        aniso::ruleT rule = {};
+        aniso::tileT tile = {};
+        aniso::torus_stepperT stepper = {};
+        int pending = 0; // Generations to run in the next `begin_frame`.
+    };
+
+    inline static std::unordered_map<uint64_t, termT> terms;
+
+    // For the "max speed" mode.
+    inline static double ms_per_gen = 0.05; // For a single preview (with all previews run in parallel).
+    inline static int max_speed_count = 0, max_speed_count_next = 0; // Previews in this mode.
+
+    inline static std::chrono::steady_clock::time_point rate_time = std::chrono::steady_clock::now();
+    inline static double rate_gens = 0; // Average generations per preview since `rate_time`.
+    inline static int gens_per_sec = 0;
+};
+
 void previewer::configT::_set() {
     ImGui::PushItemWidth(item_width);
 
@@ -1529,29 +2287,21 @@ void previewer::configT::_set() {
     imgui_Str("Density ~ 0.5, background ~ default");
     ImGui::Separator();
 
+    ImGui::BeginDisabled(max_speed);
     imgui_StepSliderInt("Step", &step, 1, 24);
     global_config::timer.slide_interval("Interval", 0, 400);
+    ImGui::EndDisabled();
     ImGui::SameLine();
     imgui_StrTooltip("(?)", "This is shared by all preview windows in the program.");
+    ImGui::Checkbox("Max speed", &max_speed);
+    guide_mode::item_tooltip(std::format(
+        "Run as many generations as fit in {} ms (for all previews together) in every frame.", budget_ms));
+    ImGui::SameLine();
+    ImGui::Text("Gen/s:%d", previewer_data::gens_per_sec);
 
     ImGui::PopItemWidth();
 }
 
-class previewer_data {
-    friend class previewer;
-
-    struct termT {
-        bool active = false;
-        bool skip_run = false;
-        int seed = 0;
-        percentT area = 0;
-        aniso::ruleT rule = {};
-        aniso::tileT tile = {};
-    };
-
-    inline static std::unordered_map<uint64_t, termT> terms;
-};
-
 void previewer::begin_frame() {
     if (!previewer_data::terms.empty()) {
         // According to https://en.cppreference.com/w/cpp/container/unordered_map/erase_if
@@ -1559,7 +2309,38 @@ void previewer::begin_frame() {
         std::erase_if(previewer_data::terms, [](std::pair<const uint64_t, previewer_data::termT>& pair) {
             return !std::exchange(pair.second.active, false);
         });
+
+        // All the previews requested in the last frame are run together (one tile per task), so the whole page
+        // is advanced in a single parallel pass. (The result is shown one frame later, which is not noticeable.)
+        std::vector<previewer_data::termT*> to_run;
+        int total = 0;
+        for (auto& [id, term] : previewer_data::terms) {
+            if (term.pending != 0) {
+                to_run.push_back(&term);
+                total += term.pending;
+            }
+        }
+        const auto start = std::chrono::steady_clock::now();
+        worker_pool().run(to_run.size(), [&](const int i) {
+            previewer_data::termT& term = *to_run[i];
+            term.stepper.run_torus(term.rule, term.tile.data(), term.pending);
+            term.pending = 0;
+        });
+        const auto now = std::chrono::steady_clock::now();
+        update_cost(previewer_data::ms_per_gen, total,
+                    std::chrono::duration<double, std::milli>(now - start).count());
+
+        if (!to_run.empty()) {
+            previewer_data::rate_gens += double(total) / to_run.size();
+        }
+        if (now - previewer_data::rate_time >= std::chrono::seconds(1)) {
+            previewer_data::gens_per_sec =
+                previewer_data::rate_gens / std::chrono::duration<double>(now - previewer_data::rate_time).count();
+            previewer_data::rate_time = now;
+            previewer_data::rate_gens = 0;
+        }
     }
+    previewer_data::max_speed_count = std::exchange(previewer_data::max_speed_count_next, 0);
 }
 
 // TODO: allow setting the step and interval with shortcuts when the window is hovered?
@@ -1598,16 +2379,26 @@ void previewer::_preview(uint64_t id, const configT& config, const aniso::ruleT&
     const bool pause = hovered && l_down;
     const bool fast = (hovered && shortcuts::test_down(ImGuiKey_F)) ||
                       (!l_down && shortcuts::keys_avail() && shortcuts::test_down(ImGuiKey_G));
-    if (fast || (!pause && (restart || (global_config::timer.test() && !std::exchange(term.skip_run, false))))) {
-        const int p = adjust_step(fast ? std::max(config.step, step_fast) : config.step, rule);
-        for (int i = 0; i < p; ++i) {
-            term.tile.run_torus(rule);
+    int step = config.step;
+    if (config.max_speed) {
+        ++previewer_data::max_speed_count_next;
+        step = budget_step(previewer_data::ms_per_gen * std::max(1, previewer_data::max_speed_count));
+    }
+    const bool timer = config.max_speed || global_config::timer.test();
+    if (fast || (!pause && (restart || (timer && !std::exchange(term.skip_run, false))))) {
+        const int p = adjust_step(fast ? std::max(step, step_fast) : step, rule);
+        if (restart) {
+            // (Run immediately, so the initial state will not be shown.)
+            term.stepper.run_torus(rule, term.tile.data(), p);
+            term.pending = 0;
+        } else {
+            term.pending = p;
         }
     }
     // Unless paused, the initial state will not be shown. This is intentional for better visual effect.
 
-    const scaleE scale_mode = config.zoom_ >= 1 ? scaleE::Nearest : scaleE::Linear;
-    const ImTextureID texture = make_screen(term.tile.data(), scale_mode);
+    const ImTextureID texture = config.zoom_ >= 1 ? make_screen(term.tile.data(), scaleE::Nearest, &term)
+                                                  : make_density_screen(term.tile.data(), int(1 / config.zoom_));
     bool hex_mode = false;
     ImGui::GetWindowDrawList()->AddImage(texture, ImGui::GetItemRectMin(), ImGui::GetItemRectMax());
     if (interactive && imgui_ItemHoveredForTooltip() && ((hex_mode = want_hex_mode(rule)) || config.zoom_ <= 1)) {
@@ -1621,7 +2412,7 @@ void previewer::_preview(uint64_t id, const configT& config, const aniso::ruleT&
                 // Using `pos` instead of (clamped.begin + .end) / 2, as otherwise the bottom-left
                 // corner cannot be fully shown.
                 hex_image(term.tile.data(), pos, clamped.size() * 3, 3);
-            } else if (scale_mode == scaleE::Nearest) {
+            } else if (config.zoom_ >= 1) {
                 ImGui::Image(texture, to_imvec(clamped.size() * 3), to_imvec(clamped.begin) / to_imvec(tile_size),
                              to_imvec(clamped.end) / to_imvec(tile_size));
             } else {
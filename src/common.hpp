@@ -75,6 +75,12 @@ namespace aniso::_misc {
 // The texture is only valid for the current frame.
 enum class scaleE { Nearest, Linear };
 [[nodiscard]] ImTextureID make_screen(aniso::_misc::tile_ref_<const bool> tile, scaleE scale);
+// The same, except that the texture is kept for `id` across frames, so only the changed areas need uploading.
+// (Each `id` should be used at most once per frame.)
+[[nodiscard]] ImTextureID make_screen(aniso::_misc::tile_ref_<const bool> tile, scaleE scale, const void* id);
+// For zoom = 1 / `block` (2, 4 or 8); each `block` * `block` area is shown as a pixel in grey levels by the density.
+// (The texture is only valid for the current frame.)
+[[nodiscard]] ImTextureID make_density_screen(aniso::_misc::tile_ref_<const bool> tile, int block);
 
 // ImGui::Image and ImGui::ImageButton for `codeT`.
 void code_image(aniso::codeT code, int zoom, const ImVec4& tint_col = ImVec4(1, 1, 1, 1),
@@ -716,6 +722,7 @@ public:
 
         int seed = 0;
         int step = 1;
+        bool max_speed = false;
 
         void _set();
         void _reset_size_zoom() {
@@ -0,0 +1,591 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "tile.hpp"
+
+namespace aniso {
+    // HashLife (quadtree of hash-consed nodes, with memoized results) for arbitrary `ruleT`.
+    // The space is an unbounded plane with a periodic background, which evolves under the rule as well.
+    // (A torus is the same as a plane whose background is the torus itself, so there is no separate mode.)
+    class hashlifeT {
+    public:
+        struct posT {
+            int64_t x, y;
+        };
+
+    private:
+        using idT = uint32_t;
+        static constexpr idT no_node = UINT32_MAX;
+
+        struct nodeT {
+            std::array<idT, 4> sub; // nw, ne, sw, se (nw ~ the corner with the smallest x and y).
+            int8_t level;           // The node covers 2^level * 2^level cells.
+            int8_t result_j;        // `result` ~ the central half advanced 2^result_j generations (-1 ~ none).
+            idT result;
+        };
+
+        struct hashT {
+            size_t operator()(const std::array<idT, 4>& sub) const {
+                uint64_t h = 0;
+                for (const idT id : sub) {
+                    h = (h ^ id) * 0x9e37'79b9'7f4a'7c15;
+                    h ^= h >> 29;
+                }
+                return h;
+            }
+        };
+
+        struct bg_keyT {
+            int level, x, y; // (x, y) ~ position % background size.
+            friend bool operator==(const bg_keyT&, const bg_keyT&) = default;
+        };
+        struct bg_hashT {
+            size_t operator()(const bg_keyT& k) const {
+                return hashT{}({idT(k.level), idT(k.x), idT(k.y), 0});
+            }
+        };
+
+        ruleT m_rule;
+        size_t m_max_nodes;
+        // While stepping, `make` stops creating nodes when the table reaches `m_max_nodes`, and sets `m_overflow`;
+        // all the results are dropped then (see `step_pow2`).
+        bool m_capped = false, m_overflow = false;
+
+        std::vector<nodeT> m_nodes{};
+        std::unordered_map<std::array<idT, 4>, idT, hashT> m_table{};
+
+        // The background at the current generation; `m_background.at(0, 0)` is bound to plane (0, 0).
+        tileT m_background{};
+        std::unordered_map<bg_keyT, idT, bg_hashT> m_bg_nodes{};
+
+        // Where the background doesn't apply. (`no_node` ~ the whole plane is background.)
+        idT m_root = no_node;
+        posT m_origin{0, 0};
+
+        uint64_t m_gen = 0;
+
+        static int64_t mod(int64_t a, int64_t r) { return ((a % r) + r) % r; }
+
+        int level(idT id) const { return m_nodes[id].level; }
+        idT sub(idT id, int q) const { return m_nodes[id].sub[q]; }
+
+        void reset_nodes() {
+            m_nodes.clear();
+            m_table.clear();
+            m_bg_nodes.clear();
+            // Leaves (single cells).
+            m_nodes.push_back({{}, 0, -1, no_node});
+            m_nodes.push_back({{}, 0, -1, no_node});
+        }
+
+        idT make(const idT nw, const idT ne, const idT sw, const idT se) {
+            if (m_capped && m_nodes.size() >= m_max_nodes) {
+                m_overflow = true;
+            }
+            if (m_overflow) {
+                return 0; // (A valid id, so the callers can go on until they return.)
+            }
+            assert(level(nw) == level(ne) && level(nw) == level(sw) && level(nw) == level(se));
+            const std::array<idT, 4> key{nw, ne, sw, se};
+            const auto [pos, inserted] = m_table.try_emplace(key, idT(m_nodes.size()));
+            if (inserted) {
+                m_nodes.push_back({key, int8_t(level(nw) + 1), -1, no_node});
+            }
+            return pos->second;
+        }
+
+        // The background node covering [pos, pos + 2^level).
+        idT bg_node(const int lv, const posT pos) {
+            const vecT size = m_background.size();
+            const int x = mod(pos.x, size.x), y = mod(pos.y, size.y);
+            if (lv == 0) {
+                return m_background.data().at(x, y);
+            }
+            const bg_keyT key{lv, x, y};
+            if (const auto find = m_bg_nodes.find(key); find != m_bg_nodes.end()) {
+                return find->second;
+            }
+            const int64_t h = int64_t(1) << (lv - 1);
+            const idT id = make(bg_node(lv - 1, pos), bg_node(lv - 1, {pos.x + h, pos.y}),
+                                bg_node(lv - 1, {pos.x, pos.y + h}), bg_node(lv - 1, {pos.x + h, pos.y + h}));
+            m_bg_nodes.emplace(key, id);
+            return id;
+        }
+
+        idT centered(const idT n) {
+            return make(sub(sub(n, 0), 3), sub(sub(n, 1), 2), sub(sub(n, 2), 1), sub(sub(n, 3), 0));
+        }
+
+        // The central half of `n`, advanced 2^j generations (j <= level - 2).
+        idT step(const idT n, const int j) {
+            if (m_overflow) {
+                return 0;
+            }
+            const int lv = level(n);
+            assert(lv >= 2 && j >= 0 && j <= lv - 2);
+            if (m_nodes[n].result_j == j) {
+                return m_nodes[n].result;
+            }
+
+            idT result = no_node;
+            if (lv == 2) {
+                // 4*4 -> 2*2.
+                bool cells[4][4]{};
+                for (int q = 0; q < 4; ++q) {
+                    for (int r = 0; r < 4; ++r) {
+                        cells[(q / 2) * 2 + r / 2][(q % 2) * 2 + r % 2] = sub(sub(n, q), r);
+                    }
+                }
+                const auto at = [&](int y, int x) {
+                    return m_rule(encode({cells[y - 1][x - 1], cells[y - 1][x], cells[y - 1][x + 1], //
+                                          cells[y][x - 1], cells[y][x], cells[y][x + 1],             //
+                                          cells[y + 1][x - 1], cells[y + 1][x], cells[y + 1][x + 1]}));
+                };
+                result = make(at(1, 1), at(1, 2), at(2, 1), at(2, 2));
+            } else {
+                const idT nw = sub(n, 0), ne = sub(n, 1), sw = sub(n, 2), se = sub(n, 3);
+                const idT n00 = nw, n02 = ne, n20 = sw, n22 = se;
+                const idT n01 = make(sub(nw, 1), sub(ne, 0), sub(nw, 3), sub(ne, 2));
+                const idT n10 = make(sub(nw, 2), sub(nw, 3), sub(sw, 0), sub(sw, 1));
+                const idT n11 = centered(n);
+                const idT n12 = make(sub(ne, 2), sub(ne, 3), sub(se, 0), sub(se, 1));
+                const idT n21 = make(sub(sw, 1), sub(se, 0), sub(sw, 3), sub(se, 2));
+
+                if (j == lv - 2) {
+                    // Two rounds of 2^(lv - 3) generations.
+                    const int j2 = lv - 3;
+                    const idT r00 = step(n00, j2), r01 = step(n01, j2), r02 = step(n02, j2);
+                    const idT r10 = step(n10, j2), r11 = step(n11, j2), r12 = step(n12, j2);
+                    const idT r20 = step(n20, j2), r21 = step(n21, j2), r22 = step(n22, j2);
+                    result = make(step(make(r00, r01, r10, r11), j2), step(make(r01, r02, r11, r12), j2),
+                                  step(make(r10, r11, r20, r21), j2), step(make(r11, r12, r21, r22), j2));
+                } else {
+                    // One round of 2^j generations; the rest are taken as is.
+                    const idT r00 = step(n00, j), r01 = step(n01, j), r02 = step(n02, j);
+                    const idT r10 = step(n10, j), r11 = step(n11, j), r12 = step(n12, j);
+                    const idT r20 = step(n20, j), r21 = step(n21, j), r22 = step(n22, j);
+                    result = make(centered(make(r00, r01, r10, r11)), centered(make(r01, r02, r11, r12)),
+                                  centered(make(r10, r11, r20, r21)), centered(make(r11, r12, r21, r22)));
+                }
+            }
+
+            if (m_overflow) {
+                return 0;
+            }
+            // (`m_nodes` may have been reallocated.)
+            m_nodes[n].result = result;
+            m_nodes[n].result_j = j;
+            return result;
+        }
+
+        // Whether the area outside of the central half of the root is all background.
+        bool root_is_centered() {
+            const int lv = level(m_root);
+            if (lv < 2) {
+                return false;
+            }
+            const int64_t q = int64_t(1) << (lv - 2);
+            for (int gy = 0; gy < 4; ++gy) {
+                for (int gx = 0; gx < 4; ++gx) {
+                    if ((gx == 1 || gx == 2) && (gy == 1 || gy == 2)) {
+                        continue;
+                    }
+                    const idT g = sub(sub(m_root, (gy / 2) * 2 + gx / 2), (gy % 2) * 2 + gx % 2);
+                    if (g != bg_node(lv - 2, {m_origin.x + gx * q, m_origin.y + gy * q})) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Wrap the root with background, keeping it centered.
+        void expand_root() {
+            const int lv = level(m_root);
+            const int64_t h = int64_t(1) << (lv - 1);
+            const posT o{m_origin.x - h, m_origin.y - h}; // The new origin.
+            const auto bg = [&](int64_t dx, int64_t dy) { return bg_node(lv - 1, {o.x + dx * h, o.y + dy * h}); };
+            const idT nw = sub(m_root, 0), ne = sub(m_root, 1), sw = sub(m_root, 2), se = sub(m_root, 3);
+            m_root = make(make(bg(0, 0), bg(1, 0), bg(0, 1), nw), make(bg(2, 0), bg(3, 0), ne, bg(3, 1)),
+                          make(bg(0, 2), sw, bg(0, 3), bg(1, 3)), make(se, bg(3, 2), bg(2, 3), bg(3, 3)));
+            m_origin = o;
+        }
+
+        // Set `dest` (covering [begin, begin + dest.size)) to the cells in `n` (at `pos`).
+        void read(const idT n, const posT pos, const tile_ref dest, const posT begin) const {
+            const int lv = level(n);
+            const int64_t s = int64_t(1) << lv;
+            if (pos.x >= begin.x + dest.size.x || pos.y >= begin.y + dest.size.y || pos.x + s <= begin.x ||
+                pos.y + s <= begin.y) {
+                return;
+            }
+            if (lv == 0) {
+                dest.at(pos.x - begin.x, pos.y - begin.y) = n;
+                return;
+            }
+            const int64_t h = s / 2;
+            read(sub(n, 0), pos, dest, begin);
+            read(sub(n, 1), {pos.x + h, pos.y}, dest, begin);
+            read(sub(n, 2), {pos.x, pos.y + h}, dest, begin);
+            read(sub(n, 3), {pos.x + h, pos.y + h}, dest, begin);
+        }
+
+        // `n` (at `pos`) with the cells in [begin, begin + pattern.size) replaced by `pattern`.
+        idT write(const idT n, const posT pos, const tile_const_ref pattern, const posT begin) {
+            const int lv = level(n);
+            const int64_t s = int64_t(1) << lv;
+            if (pos.x >= begin.x + pattern.size.x || pos.y >= begin.y + pattern.size.y || pos.x + s <= begin.x ||
+                pos.y + s <= begin.y) {
+                return n;
+            }
+            if (lv == 0) {
+                return pattern.at(pos.x - begin.x, pos.y - begin.y);
+            }
+            const int64_t h = s / 2;
+            return make(write(sub(n, 0), pos, pattern, begin), write(sub(n, 1), {pos.x + h, pos.y}, pattern, begin),
+                        write(sub(n, 2), {pos.x, pos.y + h}, pattern, begin),
+                        write(sub(n, 3), {pos.x + h, pos.y + h}, pattern, begin));
+        }
+
+        void for_each_area(const idT n, const posT pos, const int lv, tileT& temp, const auto& fn) {
+            if (n == bg_node(level(n), pos)) {
+                return;
+            } else if (level(n) <= lv) {
+                const int s = 1 << level(n);
+                temp.resize({s, s});
+                read(n, pos, temp.data(), pos);
+                fn(pos, temp.data());
+                return;
+            }
+            const int64_t h = int64_t(1) << (level(n) - 1);
+            for_each_area(sub(n, 0), pos, lv, temp, fn);
+            for_each_area(sub(n, 1), {pos.x + h, pos.y}, lv, temp, fn);
+            for_each_area(sub(n, 2), {pos.x, pos.y + h}, lv, temp, fn);
+            for_each_area(sub(n, 3), {pos.x + h, pos.y + h}, lv, temp, fn);
+        }
+
+        // The level of the background node to advance by 2^j generations.
+        int background_level(const int j) const {
+            const vecT size = m_background.size();
+            int lv = j + 2;
+            while ((int64_t(1) << (lv - 1)) < std::max(size.x, size.y)) {
+                ++lv;
+            }
+            return lv;
+        }
+
+        // Advance the plane by 2^j generations; with `capped`, return false (and change nothing) if the node table
+        // reaches `m_max_nodes` in the middle.
+        bool try_step_pow2(const int j, const bool capped) {
+            if (m_root != no_node) {
+                while (level(m_root) < j + 2 || !root_is_centered()) {
+                    expand_root();
+                }
+                expand_root(); // So that the changes cannot reach the area outside of the result.
+            }
+            const int bg_lv = background_level(j);
+            const idT bg = bg_node(bg_lv, {0, 0});
+
+            m_capped = capped;
+            const idT root_result = m_root != no_node ? step(m_root, j) : no_node;
+            const idT bg_result = step(bg, j);
+            m_capped = false;
+            if (std::exchange(m_overflow, false)) {
+                return false;
+            }
+
+            if (m_root != no_node) {
+                const int64_t q = int64_t(1) << (level(m_root) - 2);
+                m_root = root_result;
+                m_origin = {m_origin.x + q, m_origin.y + q};
+            }
+            {
+                const vecT size = m_background.size();
+                const int64_t q = int64_t(1) << (bg_lv - 2); // Where the result begins.
+                tileT temp(size), next(size);
+                read(bg_result, {q, q}, temp.data(), {q, q});
+                rotate_copy_00_to(next.data(), temp.data(), {int(mod(q, size.x)), int(mod(q, size.y))});
+                m_background.swap(next);
+                m_bg_nodes.clear();
+            }
+            m_gen += uint64_t(1) << j;
+
+            if (m_root != no_node) {
+                while (level(m_root) > 3 && root_is_centered()) {
+                    const int64_t q = int64_t(1) << (level(m_root) - 2);
+                    m_root = centered(m_root);
+                    m_origin = {m_origin.x + q, m_origin.y + q};
+                }
+            }
+            return true;
+        }
+
+        // If the step doesn't fit in `m_max_nodes`, it's split into two half steps (after collecting garbage).
+        // (A single generation is always taken, as the live nodes alone may exceed the limit.)
+        void step_pow2(const int j) {
+            if (m_nodes.size() > m_max_nodes / 2) {
+                collect_garbage();
+            }
+            if (!try_step_pow2(j, true)) {
+                collect_garbage();
+                if (j == 0) {
+                    try_step_pow2(0, false);
+                } else {
+                    step_pow2(j - 1);
+                    step_pow2(j - 1);
+                }
+            }
+        }
+
+        // Keep only the nodes reachable from the root, and drop all results.
+        void collect_garbage() {
+            std::vector<idT> remap(m_nodes.size(), no_node);
+            remap[0] = 0, remap[1] = 1;
+            if (m_root != no_node) {
+                std::vector<idT> stack{m_root};
+                while (!stack.empty()) {
+                    const idT n = stack.back();
+                    stack.pop_back();
+                    if (remap[n] == no_node) {
+                        remap[n] = 0; // Marked.
+                        for (const idT s : m_nodes[n].sub) {
+                            stack.push_back(s);
+                        }
+                    }
+                }
+            }
+
+            // Sub-nodes are always created before their parents, so the order can be preserved in one pass.
+            std::vector<nodeT> nodes;
+            nodes.reserve(m_nodes.size() / 2);
+            nodes.push_back(m_nodes[0]);
+            nodes.push_back(m_nodes[1]);
+            m_table.clear();
+            for (idT n = 2; n < m_nodes.size(); ++n) {
+                if (remap[n] != no_node) {
+                    nodeT copy = m_nodes[n];
+                    for (idT& s : copy.sub) {
+                        s = remap[s];
+                    }
+                    copy.result_j = -1;
+                    copy.result = no_node;
+                    remap[n] = nodes.size();
+                    m_table.emplace(copy.sub, remap[n]);
+                    nodes.push_back(copy);
+                }
+            }
+            nodes[0].result_j = nodes[1].result_j = -1;
+            m_nodes.swap(nodes);
+            m_bg_nodes.clear();
+            if (m_root != no_node) {
+                m_root = remap[m_root];
+            }
+        }
+
+    public:
+        // `max_nodes` ~ the limit of the node table. (Garbage is collected between the steps, and a step that
+        // doesn't fit in the limit is split into smaller steps.)
+        explicit hashlifeT(const ruleT& rule, const size_t max_nodes = 1 << 22)
+            : m_rule{rule}, m_max_nodes{max_nodes} {
+            reset_nodes();
+            m_background = tileT({1, 1});
+        }
+
+        // The plane is `background` (bound to plane (0, 0)) overwritten by `pattern` at `begin`.
+        void set_plane(const tile_const_ref background, const tile_const_ref pattern, const posT begin) {
+            set_torus(background);
+            int lv = 1;
+            while ((int64_t(1) << lv) < std::max(pattern.size.x, pattern.size.y)) {
+                ++lv;
+            }
+            tileT area({1 << lv, 1 << lv});
+            m_origin = begin;
+            for (int y = 0; y < area.size().y; ++y) {
+                for (int x = 0; x < area.size().x; ++x) {
+                    area.data().at(x, y) = x < pattern.size.x && y < pattern.size.y
+                                               ? pattern.at(x, y)
+                                               : m_background.data().at(mod(begin.x + x, m_background.size().x),
+                                                                        mod(begin.y + y, m_background.size().y));
+                }
+            }
+            const auto build = [&](const auto& build, int lv, int x, int y) -> idT {
+                if (lv == 0) {
+                    return area.data().at(x, y);
+                }
+                const int h = 1 << (lv - 1);
+                return make(build(build, lv - 1, x, y), build(build, lv - 1, x + h, y), build(build, lv - 1, x, y + h),
+                            build(build, lv - 1, x + h, y + h));
+            };
+            m_root = build(build, lv, 0, 0);
+        }
+
+        // The plane is periodic with the torus as the period.
+        void set_torus(const tile_const_ref torus) {
+            reset_nodes();
+            m_background = tileT(torus);
+            m_root = no_node;
+            m_origin = {0, 0};
+            m_gen = 0;
+        }
+
+        // The plane is `background` (bound to plane (0, 0)) everywhere. (Unlike `set_torus`, the nodes and their
+        // results are kept, so they can be reused for the new pattern.)
+        void clear(const tile_const_ref background) {
+            m_background = tileT(background);
+            m_bg_nodes.clear();
+            m_root = no_node;
+            m_origin = {0, 0};
+            m_gen = 0;
+        }
+
+        // Overwrite the area [begin, begin + pattern.size).
+        void write(const tile_const_ref pattern, const posT begin) {
+            if (m_root == no_node) {
+                m_root = bg_node(1, begin);
+                m_origin = begin;
+            }
+            while (m_origin.x > begin.x || m_origin.y > begin.y ||
+                   m_origin.x + (int64_t(1) << level(m_root)) < begin.x + pattern.size.x ||
+                   m_origin.y + (int64_t(1) << level(m_root)) < begin.y + pattern.size.y) {
+                expand_root();
+            }
+            m_root = write(m_root, m_origin, pattern, begin);
+        }
+
+        // Call `fn(begin, cells)` for each 2^lv * 2^lv area (aligned to the quadtree; may be smaller if the whole
+        // tree is smaller) that differs from the background.
+        void for_each_area(const int lv, const auto& fn) {
+            if (m_root != no_node) {
+                tileT temp{};
+                for_each_area(m_root, m_origin, lv, temp, fn);
+            }
+        }
+
+        void run(uint64_t gens) {
+            for (int j = 0; gens != 0; ++j, gens >>= 1) {
+                if (gens & 1) {
+                    step_pow2(j);
+                }
+            }
+        }
+
+        uint64_t gen() const { return m_gen; }
+        size_t node_count() const { return m_nodes.size(); }
+
+        // Whether the area that may differ from the background is within [-limit, limit) * [-limit, limit).
+        bool is_within(const int64_t limit) const {
+            if (m_root == no_node) {
+                return true;
+            }
+            const int64_t s = int64_t(1) << level(m_root);
+            return m_origin.x >= -limit && m_origin.y >= -limit && m_origin.x + s <= limit && m_origin.y + s <= limit;
+        }
+
+        // (For torus, this is the current state.)
+        tile_const_ref background() const { return m_background.data(); }
+
+        // Set `dest` to the area [begin, begin + dest.size).
+        void read(const tile_ref dest, const posT begin) const {
+            const vecT size = m_background.size();
+            tileT rotated(size);
+            rotate_copy_00_to(rotated.data(), m_background.data(),
+                              {int(mod(-begin.x, size.x)), int(mod(-begin.y, size.y))});
+            fill(dest, rotated.data());
+            if (m_root != no_node) {
+                read(m_root, m_origin, dest, begin);
+            }
+        }
+    };
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_hashlife_torus = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            for (const vecT size : {vecT{1, 1}, vecT{5, 3}, vecT{10, 12}}) {
+                tileT tile(size), compare(size);
+                random_fill(tile.data(), testT::rand, 0.5);
+                hashlifeT life(rule, 200);
+                life.set_torus(tile.data());
+                for (const int gens : {1, 2, 3, 8, 13}) {
+                    life.run(gens);
+                    for (int g = 0; g < gens; ++g) {
+                        tile.run_torus(rule);
+                    }
+                    copy(compare.data(), life.background());
+                    assert(tile == compare);
+                }
+            }
+        };
+
+        inline const testT test_hashlife_plane = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            tileT background({2, 3});
+            random_fill(background.data(), testT::rand, 0.5);
+
+            // (The changes cannot reach the border of the torus in 20 generations.)
+            tileT torus({60, 60}), compare({60, 60});
+            fill(torus.data(), background.data());
+            tileT pattern({7, 5});
+            random_fill(pattern.data(), testT::rand, 0.5);
+            copy(torus.data().clip({{24, 27}, {31, 32}}), pattern.data());
+
+            hashlifeT life(rule, 1000);
+            life.set_plane(background.data(), pattern.data(), {24, 27});
+            for (const int gens : {1, 4, 2, 13}) {
+                life.run(gens);
+                torus.run_torus(rule, gens, tileT::engineE::Plain);
+                life.read(compare.data(), {0, 0});
+                assert(torus == compare);
+            }
+
+            // The plane built by `write` (in pieces), and read back by `for_each_area`.
+            hashlifeT life2(rule, 1000);
+            life2.set_torus(life.background());
+            life2.write(compare.data().clip({{0, 0}, {60, 20}}), {0, 0});
+            life2.write(compare.data().clip({{0, 20}, {60, 60}}), {0, 20});
+            fill(compare.data(), life.background());
+            life2.for_each_area(3, [&](const hashlifeT::posT begin, const tile_const_ref area) {
+                for (int y = 0; y < area.size.y; ++y) {
+                    for (int x = 0; x < area.size.x; ++x) {
+                        if (vecT p{int(begin.x) + x, int(begin.y) + y}; p.both_gteq({0, 0}) && p.both_lt({60, 60})) {
+                            compare.data().at(p.x, p.y) = area.at(x, y);
+                        }
+                    }
+                }
+            });
+            assert(torus == compare);
+
+            // Restarted by `clear` (with the memoized results of the same rule reused).
+            life.clear(background.data());
+            life.write(pattern.data(), {24, 27});
+            assert(life.is_within(60) && !life.is_within(20));
+            fill(torus.data(), background.data());
+            copy(torus.data().clip({{24, 27}, {31, 32}}), pattern.data());
+            life.run(20);
+            torus.run_torus(rule, 20, tileT::engineE::Plain);
+            life.read(compare.data(), {0, 0});
+            assert(torus == compare);
+        };
+
+        inline const testT test_hashlife_max_nodes = [] {
+            const ruleT rule = game_of_life();
+            tileT torus({160, 160}), compare({160, 160});
+            tileT pattern({32, 32});
+            random_fill(pattern.data(), testT::rand, 0.5);
+            copy(torus.data().clip({{64, 64}, {96, 96}}), pattern.data());
+
+            // (A single `run(64)` takes ~6000 nodes without the limit.)
+            const size_t max_nodes = 3000;
+            hashlifeT life(rule, max_nodes);
+            life.set_plane(tileT({1, 1}).data(), pattern.data(), {64, 64});
+            life.run(64);
+            torus.run_torus(rule, 64, tileT::engineE::Plain);
+            life.read(compare.data(), {0, 0});
+            assert(torus == compare);
+            assert(life.node_count() <= max_nodes);
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
@@ -10,7 +10,7 @@
 #include "imgui_impl_sdlrenderer2.h"
 
 #include "common.hpp"
-#include "tile_base.hpp"
+#include "tile_pixels.hpp"
 
 [[noreturn]] static void resource_failure() {
     SDL_Log("Error: %s", SDL_GetError());
@@ -20,8 +20,10 @@
 static SDL_Window* window = nullptr;
 static SDL_Renderer* renderer = nullptr;
 
-// (Using macro in case the function is not inlined in debug mode.)
-#define color_for(b) (bool(b) ? IM_COL32_WHITE : IM_COL32_BLACK_TRANS)
+// (Using the vectorized kernels, which are selected at runtime.)
+static void to_pixels(const bool* s, Uint32* p, int len) {
+    aniso::expand_pixels(s, p, len, IM_COL32_BLACK_TRANS, IM_COL32_WHITE);
+}
 
 static SDL_Texture* create_texture(SDL_TextureAccess access, int w, int h) {
     assert(window && renderer);
@@ -38,11 +40,16 @@ static SDL_Texture* create_texture(SDL_TextureAccess access, int w, int h) {
 
 // Manage textures for `make_screen`.
 class screen_textures : no_create {
+public:
     struct blobT {
         bool used;
         int w, h;
         SDL_Texture* texture;
+        const void* id;                 // (Null for the textures that are only valid for the current frame.)
+        std::unique_ptr<bool[]> shadow; // (For `id`) the tile that is last uploaded.
     };
+
+private:
     inline static std::vector<blobT> blobs;
 
 public:
@@ -61,16 +68,37 @@ public:
         assert(window && renderer);
 
         for (blobT& blob : blobs) {
-            if (!blob.used && blob.w == w && blob.h == h) {
+            if (!blob.used && !blob.id && blob.w == w && blob.h == h) {
                 blob.used = true;
                 return blob.texture;
             }
         }
         SDL_Texture* texture = create_texture(SDL_TEXTUREACCESS_STREAMING, w, h);
-        blobs.push_back({.used = true, .w = w, .h = h, .texture = texture});
+        blobs.push_back({.used = true, .w = w, .h = h, .texture = texture, .id = nullptr, .shadow = nullptr});
         return texture;
     }
 
+    // The texture kept for `id` (recreated if the size changes). `shadow` is null if the texture is new.
+    static blobT& get(const void* id, int w, int h) {
+        assert(window && renderer && id);
+
+        for (blobT& blob : blobs) {
+            if (blob.id == id) {
+                if (blob.w != w || blob.h != h) {
+                    SDL_DestroyTexture(blob.texture);
+                    blob.w = w, blob.h = h;
+                    blob.texture = create_texture(SDL_TEXTUREACCESS_STREAMING, w, h);
+                    blob.shadow.reset();
+                }
+                blob.used = true;
+                return blob;
+            }
+        }
+        SDL_Texture* texture = create_texture(SDL_TEXTUREACCESS_STREAMING, w, h);
+        return blobs.emplace_back(
+            blobT{.used = true, .w = w, .h = h, .texture = texture, .id = id, .shadow = nullptr});
+    }
+
     static void begin_frame() {
         assert(window && renderer);
 
@@ -81,15 +109,14 @@ public:
             if (!std::exchange(blob.used, false)) { // Not used in the last frame.
                 SDL_DestroyTexture(blob.texture);
             } else {
-                *pos++ = blob;
+                *pos++ = std::move(blob);
             }
         }
         blobs.erase(pos, blobs.end());
     }
 };
 
-[[nodiscard]] ImTextureID make_screen(const aniso::_misc::tile_ref_<const bool> tile, const scaleE scale) {
-    SDL_Texture* texture = screen_textures::get(tile.size.x, tile.size.y);
+static void set_modes(SDL_Texture* texture, const scaleE scale) {
     SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
     if (scale == scaleE::Nearest) {
         SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
@@ -97,7 +124,10 @@ public:
         assert(scale == scaleE::Linear);
         SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear);
     }
+}
 
+// Upload the whole tile.
+static void upload_screen(SDL_Texture* texture, const aniso::_misc::tile_ref_<const bool> tile) {
     void* pixels = nullptr;
     int pitch = 0;
     if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0) {
@@ -107,23 +137,85 @@ public:
     if (const int pixel_size = sizeof(Uint32); pitch % pixel_size != 0) [[unlikely]] {
         assert(false); // Is this really possible?
         tile.for_each_line([&](int y, std::span<const bool> line) {
-            Uint32* p = (Uint32*)((char*)pixels + pitch * y);
-            for (bool v : line) {
-                *p++ = color_for(v);
-            }
+            to_pixels(line.data(), (Uint32*)((char*)pixels + pitch * y), line.size());
         });
     } else {
         const aniso::_misc::tile_ref_<Uint32> texture_data{(Uint32*)pixels, tile.size, pitch / pixel_size};
-        tile.for_all_data_vs(texture_data, [](const bool* s, Uint32* p, int len) {
-            for (int i = 0; i < len; ++i) {
-                p[i] = color_for(s[i]);
-            }
-        });
+        tile.for_all_data_vs(texture_data, to_pixels);
     }
     SDL_UnlockTexture(texture);
+}
+
+[[nodiscard]] ImTextureID make_screen(const aniso::_misc::tile_ref_<const bool> tile, const scaleE scale) {
+    SDL_Texture* texture = screen_textures::get(tile.size.x, tile.size.y);
+    set_modes(texture, scale);
+    upload_screen(texture, tile);
     return (ImTextureID)(intptr_t)texture;
 }
 
+[[nodiscard]] ImTextureID make_density_screen(const aniso::_misc::tile_ref_<const bool> tile, const int block) {
+    const aniso::vecT size = aniso::density_size(tile.size, block);
+    SDL_Texture* texture = screen_textures::get(size.x, size.y);
+    set_modes(texture, scaleE::Linear);
+
+    void* pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0) {
+        resource_failure();
+    }
+    assert(pitch % sizeof(Uint32) == 0);
+    aniso::expand_density(tile, block, (Uint32*)pixels, pitch / sizeof(Uint32), IM_COL32_BLACK_TRANS, IM_COL32_WHITE);
+    SDL_UnlockTexture(texture);
+    return (ImTextureID)(intptr_t)texture;
+}
+
+// Only the changed areas are converted and uploaded. The dirty rectangles are found by comparing with the last
+// uploaded tile, one rectangle for each band of rows (covering the changed columns in the band).
+// (The comparison is much cheaper than the conversion and upload, as the pixels are 4x as large as the cells.)
+[[nodiscard]] ImTextureID make_screen(const aniso::_misc::tile_ref_<const bool> tile, const scaleE scale,
+                                      const void* id) {
+    screen_textures::blobT& blob = screen_textures::get(id, tile.size.x, tile.size.y);
+    set_modes(blob.texture, scale);
+    const int w = tile.size.x, h = tile.size.y;
+    if (!blob.shadow) {
+        blob.shadow = std::make_unique_for_overwrite<bool[]>(w * h);
+        tile.for_each_line([&](int y, std::span<const bool> line) { std::ranges::copy(line, &blob.shadow[y * w]); });
+        upload_screen(blob.texture, tile);
+        return (ImTextureID)(intptr_t)blob.texture;
+    }
+
+    constexpr int band_height = 32;
+    static std::vector<Uint32> staging;
+    for (int y0 = 0; y0 < h; y0 += band_height) {
+        const int y1 = std::min(h, y0 + band_height);
+        int x0 = w, x1 = 0; // [)
+        for (int y = y0; y < y1; ++y) {
+            const bool *const s = tile.line(y), *const d = &blob.shadow[y * w];
+            const int first = std::mismatch(s, s + w, d).first - s;
+            if (first != w) {
+                int last = w;
+                while (s[last - 1] == d[last - 1]) {
+                    --last;
+                }
+                x0 = std::min(x0, first), x1 = std::max(x1, last);
+            }
+        }
+        if (x0 < x1) {
+            const SDL_Rect rect{.x = x0, .y = y0, .w = x1 - x0, .h = y1 - y0};
+            staging.resize(rect.w * rect.h);
+            for (int y = y0; y < y1; ++y) {
+                const bool* const s = tile.line(y) + x0;
+                to_pixels(s, staging.data() + (y - y0) * rect.w, rect.w);
+                std::copy_n(s, rect.w, &blob.shadow[y * w + x0]);
+            }
+            if (SDL_UpdateTexture(blob.texture, &rect, staging.data(), rect.w * sizeof(Uint32)) != 0) {
+                resource_failure();
+            }
+        }
+    }
+    return (ImTextureID)(intptr_t)blob.texture;
+}
+
 // Manage the texture for `code_image` and `code_button`.
 class code_atlas : no_create {
     inline static SDL_Texture* texture = nullptr;
@@ -138,16 +230,14 @@ public:
         SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
 
         // Using heap allocation to avoid "Function uses XXX bytes of stack" warning.
-        std::unique_ptr<Uint32[][3][3]> pixels(new Uint32[512][3][3]);
+        std::unique_ptr<bool[][3][3]> cells(new bool[512][3][3]);
         aniso::for_each_code([&](aniso::codeT code) {
             const aniso::situT situ = aniso::decode(code);
             const bool fill[3][3] = {{situ.q, situ.w, situ.e}, {situ.a, situ.s, situ.d}, {situ.z, situ.x, situ.c}};
-            for (int y = 0; y < 3; ++y) {
-                for (int x = 0; x < 3; ++x) {
-                    pixels[code][y][x] = color_for(fill[y][x]);
-                }
-            }
+            std::copy_n(&fill[0][0], 9, &cells[code][0][0]);
         });
+        std::unique_ptr<Uint32[][3][3]> pixels(new Uint32[512][3][3]);
+        to_pixels(&cells[0][0][0], &pixels[0][0][0], 512 * 3 * 3);
 
         SDL_UpdateTexture(texture, nullptr, pixels.get(), width * sizeof(Uint32));
     }
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "rule.hpp"
+
+namespace aniso {
+    // A boolean network (of AND/OR/XOR/NOT gates) that computes the same function as a `ruleT`.
+    // The inputs are the 9 neighbor "bit-planes", so the network can be evaluated for many cells at once
+    // (one cell per bit) with plain word operations.
+    class circuitT {
+    public:
+        enum opE : uint8_t { And, Or, Xor, AndNot /* ~a & b */, OrNot /* ~a | b */, Not /* ~a */ };
+        struct gateT {
+            opE op;
+            uint16_t a, b;
+        };
+
+        // Node ids: [0, 9) ~ inputs (indexed by `codeT::bposE`), 9 ~ const 0, 10 ~ const 1, then the outputs of
+        // `m_gates` in order.
+        static constexpr int node_0 = 9, node_1 = 10, first_gate = 11;
+
+        // Alternative implementation of `run<runner_lanes>` (e.g. the generated code in "rule_jit.hpp").
+        static constexpr int runner_lanes = 16;
+        struct runnerT {
+            virtual ~runnerT() = default;
+            // Set the outputs of the gates (with the inputs and constants already set).
+            virtual void run(uint64_t* nodes) const = 0;
+        };
+
+    private:
+        std::vector<gateT> m_gates{};
+        int m_output = node_0;
+        std::shared_ptr<const runnerT> m_runner{}; // (Optional.)
+
+        // Truth table of a function of the 9 inputs; bit `code` ~ the value for `code`.
+        using ttT = std::array<uint64_t, 8>;
+
+        static ttT negate(ttT f) {
+            for (uint64_t& w : f) {
+                w = ~w;
+            }
+            return f;
+        }
+
+        static ttT exclusive_or(ttT a, const ttT& b) {
+            for (int i = 0; i < 8; ++i) {
+                a[i] ^= b[i];
+            }
+            return a;
+        }
+
+        // f|(v=b), still as a function of all the inputs.
+        static ttT cofactor(const ttT& f, const int v, const bool b) {
+            ttT r{};
+            if (v >= 6) {
+                const int s = 1 << (v - 6);
+                for (int i = 0; i < 8; ++i) {
+                    r[i] = f[b ? (i | s) : (i & ~s)];
+                }
+            } else {
+                static constexpr uint64_t masks[6]{0x5555'5555'5555'5555, 0x3333'3333'3333'3333,
+                                                   0x0f0f'0f0f'0f0f'0f0f, 0x00ff'00ff'00ff'00ff,
+                                                   0x0000'ffff'0000'ffff, 0x0000'0000'ffff'ffff};
+                const int s = 1 << v;
+                for (int i = 0; i < 8; ++i) {
+                    r[i] = b ? (f[i] & ~masks[v]) | ((f[i] & ~masks[v]) >> s) //
+                             : (f[i] & masks[v]) | ((f[i] & masks[v]) << s);
+                }
+            }
+            return r;
+        }
+
+        // Shannon decomposition along a fixed order of inputs, with hash-consing of sub-functions.
+        class builderT {
+            static constexpr ttT all_0{};
+            inline static const ttT all_1 = negate({});
+
+            const std::array<int, 9>& order;
+            const bool prefer_xor; // f = f0 ^ (v & (f0 ^ f1)) instead of (~v & f0) | (v & f1).
+            std::map<ttT, int> known{};
+
+        public:
+            std::vector<gateT> gates{};
+
+            builderT(const std::array<int, 9>& order, bool prefer_xor) : order{order}, prefer_xor{prefer_xor} {}
+
+            int emit(opE op, int a, int b) {
+                gates.push_back({op, uint16_t(a), uint16_t(b)});
+                return first_gate + int(gates.size()) - 1;
+            }
+
+            int build(const ttT& f, int depth) {
+                if (f == all_0) {
+                    return node_0;
+                } else if (f == all_1) {
+                    return node_1;
+                } else if (const auto find = known.find(f); find != known.end()) {
+                    return find->second;
+                } else if (const auto find = known.find(negate(f)); find != known.end()) {
+                    return known[f] = emit(Not, find->second, 0);
+                }
+
+                ttT f0{}, f1{};
+                int v = -1;
+                while (depth < 9) {
+                    v = order[depth++];
+                    f0 = cofactor(f, v, 0);
+                    f1 = cofactor(f, v, 1);
+                    if (f0 != f1) {
+                        break;
+                    }
+                }
+                assert(v != -1 && f0 != f1);
+
+                int node = 0;
+                if (f0 == all_0 && f1 == all_1) {
+                    node = v;
+                } else if (f0 == all_1 && f1 == all_0) {
+                    node = emit(Not, v, 0);
+                } else if (f0 == negate(f1)) {
+                    node = emit(Xor, v, build(f0, depth));
+                } else if (f0 == all_0) {
+                    node = emit(And, v, build(f1, depth));
+                } else if (f1 == all_0) {
+                    node = emit(AndNot, v, build(f0, depth));
+                } else if (f0 == all_1) {
+                    node = emit(OrNot, v, build(f1, depth));
+                } else if (f1 == all_1) {
+                    node = emit(Or, v, build(f0, depth));
+                } else if (prefer_xor) {
+                    const int n0 = build(f0, depth);
+                    const int diff = build(exclusive_or(f0, f1), depth);
+                    node = emit(Xor, n0, emit(And, v, diff));
+                } else {
+                    const int n0 = build(f0, depth);
+                    const int n1 = build(f1, depth);
+                    node = emit(Or, emit(AndNot, v, n0), emit(And, v, n1));
+                }
+                return known[f] = node;
+            }
+        };
+
+    public:
+        // Try several input orders (and both decompositions), and keep the smallest network.
+        explicit circuitT(const ruleT& rule) {
+            ttT f{};
+            for_each_code([&](codeT code) { f[code >> 6] |= uint64_t(rule[code]) << (code & 63); });
+
+            using enum codeT::bposE;
+            std::array<int, 9> order{bpos_s, bpos_q, bpos_w, bpos_e, bpos_a, bpos_d, bpos_z, bpos_x, bpos_c};
+            bool first = true;
+            for (int i = 0; i < 9; ++i) {
+                std::rotate(order.begin(), order.begin() + 1, order.end());
+                for (const bool prefer_xor : {false, true}) {
+                    builderT builder(order, prefer_xor);
+                    const int output = builder.build(f, 0);
+                    if (first || builder.gates.size() < m_gates.size()) {
+                        first = false;
+                        m_gates = std::move(builder.gates);
+                        m_output = output;
+                    }
+                }
+            }
+            assert(m_gates.size() + first_gate <= UINT16_MAX);
+        }
+
+        int gate_count() const { return m_gates.size(); }
+        int node_count() const { return first_gate + m_gates.size(); }
+        const std::vector<gateT>& gates() const { return m_gates; }
+        int output() const { return m_output; }
+
+        void set_runner(std::shared_ptr<const runnerT> runner) { m_runner = std::move(runner); }
+
+        // `nodes` should have `node_count() * lanes` words, with the inputs at [0, 9 * lanes) (node-major).
+        // Returns the output (`lanes` words).
+        template <int lanes>
+        const uint64_t* run(uint64_t* const nodes) const {
+            std::fill_n(nodes + node_0 * lanes, lanes, 0);
+            std::fill_n(nodes + node_1 * lanes, lanes, ~uint64_t(0));
+            if constexpr (lanes == runner_lanes) {
+                if (m_runner) {
+                    m_runner->run(nodes);
+                    return nodes + m_output * lanes;
+                }
+            }
+            uint64_t* out = nodes + first_gate * lanes;
+            for (const gateT& gate : m_gates) {
+                // (Copied to local arrays, so the compiler knows `out` doesn't overlap the operands.)
+                uint64_t a[lanes], b[lanes], r[lanes];
+                std::copy_n(nodes + gate.a * lanes, lanes, a);
+                std::copy_n(nodes + gate.b * lanes, lanes, b);
+                switch (gate.op) {
+                    case And: for (int l = 0; l < lanes; ++l) r[l] = a[l] & b[l]; break;
+                    case Or: for (int l = 0; l < lanes; ++l) r[l] = a[l] | b[l]; break;
+                    case Xor: for (int l = 0; l < lanes; ++l) r[l] = a[l] ^ b[l]; break;
+                    case AndNot: for (int l = 0; l < lanes; ++l) r[l] = ~a[l] & b[l]; break;
+                    case OrNot: for (int l = 0; l < lanes; ++l) r[l] = ~a[l] | b[l]; break;
+                    default: assert(gate.op == Not); for (int l = 0; l < lanes; ++l) r[l] = ~a[l];
+                }
+                std::copy_n(r, lanes, out);
+                out += lanes;
+            }
+            return nodes + m_output * lanes;
+        }
+    };
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_circuitT = [] {
+            // All 512 codes as 8 lanes.
+            std::vector<uint64_t> nodes;
+            const auto test = [&nodes](const ruleT& rule) {
+                const circuitT circuit(rule);
+                nodes.assign(circuit.node_count() * 8, 0);
+                for_each_code([&](codeT code) {
+                    for (int v = 0; v < 9; ++v) {
+                        nodes[v * 8 + (code >> 6)] |= uint64_t((code >> v) & 1) << (code & 63);
+                    }
+                });
+                const uint64_t* const out = circuit.run<8>(nodes.data());
+                for_each_code([&](codeT code) { assert(bool((out[code >> 6] >> (code & 63)) & 1) == rule[code]); });
+                return circuit.gate_count();
+            };
+
+            assert(test(ruleT{}) == 0);
+            assert(test(make_rule([](codeT c) { return c.get(codeT::bpos_q); })) == 0);
+            assert(test(make_rule([](codeT c) { return !c.get(codeT::bpos_s); })) == 1);
+            test(game_of_life());
+            test(make_rule([](codeT) { return testT::rand() & 1; }));
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
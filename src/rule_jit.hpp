@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstring>
+#include <unordered_map>
+
+#include "rule_circuit.hpp"
+
+// Machine code is generated only for x86-64 (and can be disabled by DISABLE_JIT); otherwise `compile_circuit`
+// returns null, and the circuits are evaluated by `circuitT::run` as usual.
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(DISABLE_JIT)
+#define ANISO_JIT
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif // x86-64
+
+namespace aniso {
+#ifdef ANISO_JIT
+    namespace _misc {
+        // Straight-line SSE2 code for the gates, as `void(uint64_t* nodes)`.
+        // Each gate is calculated as 8 x 128-bit chunks in xmm0-7, and the result is kept in the registers, so
+        // the next gate doesn't need to load it again if it takes the result as an operand (which is common).
+        inline std::vector<uint8_t> gen_circuit_code(const circuitT& circuit) {
+            constexpr int lanes = circuitT::runner_lanes;
+            constexpr int chunks = lanes * 8 / 16;
+            static_assert(chunks == 8);
+
+            std::vector<uint8_t> code;
+            const auto emit = [&code](std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); };
+            // op xmm<k>, [rax + disp32]
+            const auto emit_mem = [&](std::initializer_list<uint8_t> opcode, int k, int node, int chunk) {
+                const int32_t disp = (node * lanes + chunk * 2) * 8;
+                emit(opcode);
+                code.push_back(0x80 | (k << 3));
+                for (int i = 0; i < 4; ++i) {
+                    code.push_back(uint8_t(disp >> (8 * i)));
+                }
+            };
+            const auto load = [&](int k, int node) { emit_mem({0xf3, 0x0f, 0x6f}, k, node, k); };  // movdqu
+            const auto store = [&](int k, int node) { emit_mem({0xf3, 0x0f, 0x7f}, k, node, k); }; // movdqu
+            const auto pand = [&](int k, int node) { emit_mem({0x66, 0x0f, 0xdb}, k, node, k); };
+            const auto pandn = [&](int k, int node) { emit_mem({0x66, 0x0f, 0xdf}, k, node, k); };
+            const auto por = [&](int k, int node) { emit_mem({0x66, 0x0f, 0xeb}, k, node, k); };
+            const auto pxor = [&](int k, int node) { emit_mem({0x66, 0x0f, 0xef}, k, node, k); };
+
+#ifdef _WIN32
+            emit({0x48, 0x89, 0xc8});                   // mov rax, rcx
+            emit({0x48, 0x83, 0xec, 0x28});             // sub rsp, 40
+            emit({0xf3, 0x0f, 0x7f, 0x34, 0x24});       // movdqu [rsp], xmm6 (callee-saved)
+            emit({0xf3, 0x0f, 0x7f, 0x7c, 0x24, 0x10}); // movdqu [rsp + 16], xmm7
+#else
+            emit({0x48, 0x89, 0xf8}); // mov rax, rdi
+#endif
+
+            using enum circuitT::opE;
+            int held = -1; // The node in xmm0-7.
+            int node = circuitT::first_gate;
+            for (circuitT::gateT gate : circuit.gates()) {
+                if (gate.b == held && gate.a != held && (gate.op == And || gate.op == Or || gate.op == Xor)) {
+                    std::swap(gate.a, gate.b);
+                }
+                for (int k = 0; k < chunks; ++k) {
+                    if (gate.a != held) {
+                        load(k, gate.a);
+                    }
+                    switch (gate.op) {
+                        case And: pand(k, gate.b); break;
+                        case Or: por(k, gate.b); break;
+                        case Xor: pxor(k, gate.b); break;
+                        case AndNot: pandn(k, gate.b); break; // ~xmm & m
+                        case OrNot: pxor(k, circuitT::node_1), por(k, gate.b); break;
+                        default: assert(gate.op == Not); pxor(k, circuitT::node_1);
+                    }
+                    store(k, node);
+                }
+                held = node++;
+            }
+
+#ifdef _WIN32
+            emit({0xf3, 0x0f, 0x6f, 0x34, 0x24});       // movdqu xmm6, [rsp]
+            emit({0xf3, 0x0f, 0x6f, 0x7c, 0x24, 0x10}); // movdqu xmm7, [rsp + 16]
+            emit({0x48, 0x83, 0xc4, 0x28});             // add rsp, 40
+#endif
+            emit({0xc3}); // ret
+            return code;
+        }
+
+        class jit_runnerT : public circuitT::runnerT {
+            void* m_page = nullptr;
+            size_t m_size = 0;
+
+        public:
+            explicit jit_runnerT(const std::vector<uint8_t>& code) : m_size{code.size()} {
+#ifdef _WIN32
+                m_page = VirtualAlloc(nullptr, m_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+                if (m_page) {
+                    std::memcpy(m_page, code.data(), m_size);
+                    DWORD old{};
+                    if (!VirtualProtect(m_page, m_size, PAGE_EXECUTE_READ, &old)) {
+                        VirtualFree(m_page, 0, MEM_RELEASE);
+                        m_page = nullptr;
+                    } else {
+                        FlushInstructionCache(GetCurrentProcess(), m_page, m_size);
+                    }
+                }
+#else
+                m_page = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (m_page == MAP_FAILED) {
+                    m_page = nullptr;
+                } else {
+                    std::memcpy(m_page, code.data(), m_size);
+                    if (mprotect(m_page, m_size, PROT_READ | PROT_EXEC) != 0) { // (May be forbidden by policy.)
+                        munmap(m_page, m_size);
+                        m_page = nullptr;
+                    }
+                }
+#endif
+            }
+
+            jit_runnerT(const jit_runnerT&) = delete;
+            jit_runnerT& operator=(const jit_runnerT&) = delete;
+
+            ~jit_runnerT() override {
+                if (m_page) {
+#ifdef _WIN32
+                    VirtualFree(m_page, 0, MEM_RELEASE);
+#else
+                    munmap(m_page, m_size);
+#endif
+                }
+            }
+
+            bool ok() const { return m_page; }
+
+            void run(uint64_t* const nodes) const override {
+                assert(uintptr_t(nodes) % 16 == 0); // (Required by the SSE2 memory operands.)
+                reinterpret_cast<void (*)(uint64_t*)>(m_page)(nodes);
+            }
+        };
+    } // namespace _misc
+#endif // ANISO_JIT
+
+    // Generate machine code for `circuit.run<circuitT::runner_lanes>`; null if not supported.
+    inline std::shared_ptr<const circuitT::runnerT> compile_circuit([[maybe_unused]] const circuitT& circuit) {
+#ifdef ANISO_JIT
+        auto runner = std::make_shared<_misc::jit_runnerT>(_misc::gen_circuit_code(circuit));
+        if (runner->ok()) {
+            return runner;
+        }
+#endif
+        return nullptr;
+    }
+
+    // The compiled code for recent rules (so that switching back to a rule doesn't compile again).
+    class jit_cacheT {
+        static constexpr int max_size = 32;
+        std::unordered_map<compressT, std::shared_ptr<const circuitT::runnerT>, compressT::hashT> m_map{};
+
+    public:
+        // (`circuit` should be derived from `rule` in the same way in each call.)
+        std::shared_ptr<const circuitT::runnerT> get(const ruleT& rule, const circuitT& circuit) {
+            if (const auto find = m_map.find(rule); find != m_map.end()) {
+                return find->second;
+            }
+            if (m_map.size() >= max_size) {
+                m_map.clear();
+            }
+            return m_map[rule] = compile_circuit(circuit);
+        }
+    };
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_compile_circuit = [] {
+            constexpr int lanes = circuitT::runner_lanes;
+            for (const ruleT& rule : {ruleT{}, game_of_life(), make_rule([](codeT) { return testT::rand() & 1; })}) {
+                circuitT a(rule), b(rule);
+                b.set_runner(compile_circuit(b));
+
+                std::vector<uint64_t> nodes_a(a.node_count() * lanes), nodes_b(b.node_count() * lanes);
+                for (int i = 0; i < 9 * lanes; ++i) {
+                    nodes_a[i] = nodes_b[i] = (uint64_t(testT::rand()) << 32) | testT::rand();
+                }
+                const uint64_t* const out_a = a.run<lanes>(nodes_a.data());
+                const uint64_t* const out_b = b.run<lanes>(nodes_b.data());
+                assert(std::equal(out_a, out_a + lanes, out_b));
+            }
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
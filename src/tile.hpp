@@ -32,6 +32,22 @@ namespace aniso {
                 return j;
             }
         };
+
+        // Repeat `rep` (of `p` cells, starting from `rep[x0]`) to fill `line`.
+        // (Only the first period is copied cell by cell; then the line is doubled by `copy_n`.)
+        inline void fill_periodic_line(const std::span<bool> line, const bool* const rep, const int p, int x0) {
+            assert(p > 0 && x0 >= 0 && x0 < p);
+            const int n = line.size();
+            for (int x = 0; x < std::min(n, p); ++x) {
+                line[x] = rep[x0++];
+                if (x0 == p) {
+                    x0 = 0;
+                }
+            }
+            for (int k = p; k < n; k *= 2) {
+                std::copy_n(line.data(), std::min(k, n - k), line.data() + k);
+            }
+        }
     } // namespace _misc
 
     inline int count(const tile_const_ref tile) {
@@ -158,11 +174,8 @@ namespace aniso {
         }
 
         _misc::wrapped_int dy(0, repeat.size.y);
-        tile.for_each_line([&](const int y, std::span<bool> line) {
-            const bool* const rep = repeat.line(dy++);
-            for (_misc::wrapped_int dx(0, repeat.size.x); bool& b : line) {
-                b = rep[dx++];
-            }
+        tile.for_each_line([&](int, std::span<bool> line) {
+            _misc::fill_periodic_line(line, repeat.line(dy++), repeat.size.x, 0);
         });
     }
 
@@ -186,20 +199,15 @@ namespace aniso {
         }
 
         assert(tile.contains(range));
-        const auto fill = [](std::span<bool> line, const bool* rep, _misc::wrapped_int dx) {
-            for (bool& b : line) {
-                b = rep[dx++];
-            }
-        };
-
+        const int p = repeat.size.x;
         _misc::wrapped_int dy(0, repeat.size.y);
         tile.for_each_line([&](const int y, std::span<bool> line) {
             const bool* const rep = repeat.line(dy++);
             if (y < range.begin.y || y >= range.end.y) {
-                fill(line, rep, {0, repeat.size.x});
+                _misc::fill_periodic_line(line, rep, p, 0);
             } else {
-                fill(line.first(range.begin.x), rep, {0, repeat.size.x});
-                fill(line.subspan(range.end.x), rep, {range.end.x % repeat.size.x, repeat.size.x});
+                _misc::fill_periodic_line(line.first(range.begin.x), rep, p, 0);
+                _misc::fill_periodic_line(line.subspan(range.end.x), rep, p, range.end.x % p);
             }
         });
     }
@@ -231,20 +239,26 @@ namespace aniso {
             return bounding_box(tile, *repeat.data);
         }
 
+        // (Each line is compared with the background line of the same width, so the lines can be scanned by
+        // `std::mismatch` from both ends instead of checking every cell.)
+        const int width = tile.size.x;
+        const auto bg_data = std::make_unique_for_overwrite<bool[]>(repeat.size.y * width);
+        for (int y = 0; y < repeat.size.y; ++y) {
+            _misc::fill_periodic_line({bg_data.get() + y * width, size_t(width)}, repeat.line(y), repeat.size.x, 0);
+        }
+
         int min_x = INT_MAX, max_x = INT_MIN;
         int min_y = INT_MAX, max_y = INT_MIN;
         _misc::wrapped_int dy(0, repeat.size.y);
         tile.for_each_line([&](const int y, std::span<const bool> line) {
-            const bool* const rep = repeat.line(dy++);
-            _misc::wrapped_int dx(0, repeat.size.x);
-            for (int x = 0; const bool b : line) {
-                if (b != rep[dx++]) {
-                    min_x = std::min(min_x, x);
-                    max_x = std::max(max_x, x);
-                    min_y = std::min(min_y, y);
-                    max_y = std::max(max_y, y);
-                }
-                ++x;
+            const bool* const bg = bg_data.get() + dy++ * width;
+            const auto first = std::mismatch(line.begin(), line.end(), bg).first;
+            if (first != line.end()) {
+                const auto last = std::mismatch(line.rbegin(), line.rend(), std::reverse_iterator(bg + width)).first;
+                min_x = std::min(min_x, int(first - line.begin()));
+                max_x = std::max(max_x, int(line.rend() - last) - 1);
+                min_y = std::min(min_y, y);
+                max_y = std::max(max_y, y);
             }
         });
         if (max_x != INT_MIN) {
@@ -254,44 +268,92 @@ namespace aniso {
         }
     }
 
-    // `tile.size` -> non-periodic, or the period is too large
+    namespace _misc {
+        // The smallest p (in [1, n]) for which `has_period(p)`, where p is a period of `seq` (seq[i] == seq[i - p]
+        // for i >= p), and `has_period` verifies the period on the real data.
+        // The periods of `seq` are `n - border` for each border (both prefix and suffix) in the prefix-function
+        // chain, so the candidates are tried in increasing order. (`seq` is the hash of the real data, so a real
+        // period is always a period of `seq`.)
+        inline int smallest_period(const std::span<const uint64_t> seq, const auto& has_period) {
+            const int n = seq.size();
+            std::vector<int> pi(n, 0);
+            for (int i = 1; i < n; ++i) {
+                int k = pi[i - 1];
+                while (k > 0 && seq[i] != seq[k]) {
+                    k = pi[k - 1];
+                }
+                pi[i] = k + (seq[i] == seq[k]);
+            }
+            for (int border = n > 0 ? pi[n - 1] : 0; border > 0; border = pi[border - 1]) {
+                if (has_period(n - border)) {
+                    return n - border;
+                }
+            }
+            return n;
+        }
+    } // namespace _misc
+
+    // `tile.size` -> non-periodic.
+    // (The rows and columns are hashed, and the period is found by the prefix function of the hash sequences, and
+    // then verified line by line; so this costs O(size.xy()) instead of trying every period.)
     inline vecT spatial_period(const tile_const_ref tile) {
-        auto has_period_x = [tile](const int p_x) -> bool {
+        const uint64_t mul = 0x9e37'79b9'7f4a'7c15;
+        std::vector<uint64_t> col_hash(tile.size.x, 0), row_hash(tile.size.y, 0);
+        tile.for_each_line([&](const int y, std::span<const bool> line) {
+            uint64_t hash = 0;
+            for (int x = 0; const bool b : line) {
+                col_hash[x] = (col_hash[x] ^ b) * mul;
+                hash = (hash ^ b) * mul;
+                ++x;
+            }
+            row_hash[y] = hash;
+        });
+
+        const int p_x = _misc::smallest_period(col_hash, [tile](const int p_x) {
             for (int y = 0; y < tile.size.y; ++y) {
-                for (int x = p_x; x < tile.size.x; ++x) {
-                    if (tile.at(x, y) != tile.at(x - p_x, y)) {
-                        return false;
-                    }
+                const bool* const line = tile.line(y);
+                if (!std::equal(line + p_x, line + tile.size.x, line)) {
+                    return false;
                 }
             }
             return true;
-        };
-
-        auto has_period_y = [tile](const int p_y) -> bool {
+        });
+        const int p_y = _misc::smallest_period(row_hash, [tile](const int p_y) {
             for (int y = p_y; y < tile.size.y; ++y) {
-                for (int x = 0; x < tile.size.x; ++x) {
-                    if (tile.at(x, y) != tile.at(x, y - p_y)) {
-                        return false;
-                    }
+                if (!std::equal(tile.line(y), tile.line(y) + tile.size.x, tile.line(y - p_y))) {
+                    return false;
                 }
             }
             return true;
-        };
+        });
+        return {.x = p_x, .y = p_y};
+    }
 
-        vecT p_size = tile.size;
-        for (int x = 1; x < std::min(tile.size.x, 60); ++x) {
-            if (has_period_x(x)) {
-                p_size.x = x;
-                break;
-            }
-        }
-        for (int y = 1; y < std::min(tile.size.y, 60); ++y) {
-            if (has_period_y(y)) {
-                p_size.y = y;
-                break;
+    // The period (at most `max_size`) of the border of `tile`, i.e. the `period` for which the cells that don't
+    // match `tile.clip({{0, 0}, period})` are surrounded by at least a period of matching cells (or there are no
+    // such cells). If there are several ones, the one with the smallest bounding box (then the smallest period) is
+    // taken. `nullopt` -> no such period.
+    // (Every candidate is tested against the whole tile, as the periods of the top rows and the left columns alone
+    // can be smaller than the real one, e.g. when they are uniform.)
+    inline std::optional<vecT> border_period(const tile_const_ref tile, const vecT max_size) {
+        std::optional<vecT> period{};
+        int min_area = INT_MAX;
+        for (int y = 1; y <= max_size.y; ++y) {
+            for (int x = 1; x <= max_size.x; ++x) {
+                const vecT p{x, y};
+                if (!p.both_lteq(tile.size)) {
+                    continue;
+                }
+                const rangeT range = bounding_box(tile, tile.clip({{0, 0}, p}));
+                const int area = range.empty() ? 0 : range.size().xy();
+                if ((range.empty() || (range.begin.both_gteq(p) && range.end.both_lteq(tile.size - p))) &&
+                    (area < min_area || (area == min_area && p.xy() < period->xy()))) {
+                    period = p;
+                    min_area = area;
+                }
             }
         }
-        return p_size;
+        return period;
     }
 
 #ifdef ENABLE_TESTS
@@ -312,6 +374,103 @@ namespace aniso {
             assert(!test_range.empty());
             assert(test_range.begin == inner_range.begin && test_range.end == inner_range.end);
         };
+
+        inline const testT test_spatial_period = [] {
+            const auto naive = [](const tile_const_ref tile) {
+                vecT p_size = tile.size;
+                for (int p = tile.size.x - 1; p >= 1; --p) {
+                    bool periodic = true;
+                    for (int y = 0; y < tile.size.y; ++y) {
+                        for (int x = p; x < tile.size.x; ++x) {
+                            periodic = periodic && tile.at(x, y) == tile.at(x - p, y);
+                        }
+                    }
+                    if (periodic) {
+                        p_size.x = p;
+                    }
+                }
+                for (int p = tile.size.y - 1; p >= 1; --p) {
+                    bool periodic = true;
+                    for (int y = p; y < tile.size.y; ++y) {
+                        for (int x = 0; x < tile.size.x; ++x) {
+                            periodic = periodic && tile.at(x, y) == tile.at(x, y - p);
+                        }
+                    }
+                    if (periodic) {
+                        p_size.y = p;
+                    }
+                }
+                return p_size;
+            };
+
+            for (int i = 0; i < 20; ++i) {
+                const vecT size{.x = int(testT::rand() % 150) + 1, .y = int(testT::rand() % 90) + 1};
+                const vecT rep_size{.x = int(testT::rand() % 80) + 1, .y = int(testT::rand() % 80) + 1};
+                const auto data = std::make_unique_for_overwrite<bool[]>(size.xy() + rep_size.xy());
+                const tile_ref tile{data.get(), size}, rep{data.get() + size.xy(), rep_size};
+                random_fill(rep, testT::rand, i % 2 ? 0.5 : 0.02); // (Sparse ones have smaller sub-periods.)
+                fill(tile, rep);
+                if (i % 3 == 0) {
+                    tile.at(testT::rand() % size.x, testT::rand() % size.y) ^= true;
+                }
+                assert(spatial_period(tile) == naive(tile));
+            }
+        };
+
+        inline const testT test_border_period = [] {
+            const bool corner[4]{0, 0, 0, 1};     // The first row and column are uniform.
+            const bool dots[9]{0, 0, 0, 0, 1, 0}; // (So are the dots in 3*3 lattice.)
+            const bool lines[4]{1, 0, 0, 0};
+            for (const tile_const_ref rep : {tile_const_ref{corner, {2, 2}}, tile_const_ref{dots, {3, 3}},
+                                             tile_const_ref{lines, {4, 1}}, tile_const_ref{lines, {1, 4}}}) {
+                const vecT size{.x = int(testT::rand() % 10) + 20, .y = int(testT::rand() % 10) + 20};
+                const auto data = std::make_unique_for_overwrite<bool[]>(size.xy());
+                const tile_ref tile{data.get(), size};
+                fill(tile, rep);
+                assert(border_period(tile, {4, 4}) == std::optional{rep.size});
+
+                const rangeT range{{8, 8}, {12, 12}};
+                random_fill(tile.clip(range), testT::rand, 0.5);
+                tile.at(10, 10) = !rep.at(10 % rep.size.x, 10 % rep.size.y);
+                assert(border_period(tile, {4, 4}) == std::optional{rep.size});
+                assert(!border_period(tile.clip({{10, 0}, size}), {4, 4})); // Not enclosed.
+            }
+        };
+
+        inline const testT test_fill_periodic = [] {
+            const vecT size{.x = int(testT::rand() % 70) + 1, .y = int(testT::rand() % 10) + 1};
+            const vecT rep_size{.x = int(testT::rand() % 4) + 1, .y = int(testT::rand() % 4) + 1};
+            const auto data = std::make_unique_for_overwrite<bool[]>(size.xy());
+            const auto rep_data = std::make_unique_for_overwrite<bool[]>(rep_size.xy());
+            const tile_ref tile{data.get(), size}, rep{rep_data.get(), rep_size};
+            random_fill(rep, testT::rand, 0.5);
+            const auto is_bg = [&](int x, int y) { return tile.at(x, y) == rep.at(x % rep_size.x, y % rep_size.y); };
+
+            fill(tile, rep);
+            for (int y = 0; y < size.y; ++y) {
+                for (int x = 0; x < size.x; ++x) {
+                    assert(is_bg(x, y));
+                }
+            }
+            assert(bounding_box(tile, rep).empty());
+
+            const vecT a{.x = int(testT::rand() % size.x), .y = int(testT::rand() % size.y)};
+            const vecT b{.x = int(testT::rand() % size.x), .y = int(testT::rand() % size.y)};
+            const rangeT range{min(a, b), max(a, b).plus(1, 1)};
+            fill(tile.clip(range), 0);
+            fill_outside(tile, range, rep);
+            tile.at(range.begin.x, range.begin.y) = !rep.at(range.begin.x % rep_size.x, range.begin.y % rep_size.y);
+            tile.at(range.end.x - 1, range.end.y - 1) =
+                !rep.at((range.end.x - 1) % rep_size.x, (range.end.y - 1) % rep_size.y);
+            for (int y = 0; y < size.y; ++y) {
+                for (int x = 0; x < size.x; ++x) {
+                    const bool inside = vecT{x, y}.both_gteq(range.begin) && vecT{x, y}.both_lt(range.end);
+                    assert(inside || is_bg(x, y));
+                }
+            }
+            const rangeT test_range = bounding_box(tile, rep);
+            assert(test_range.begin == range.begin && test_range.end == range.end);
+        };
     } // namespace _tests
 #endif // ENABLE_TESTS
 
@@ -588,49 +747,99 @@ namespace aniso {
     using border_ref = _misc::border_ref_<false /* !is_const */>;
     using border_const_ref = _misc::border_ref_<true /* is_const */>;
 
+    // The set of invoked codes, as 512 bits.
+    class code_bitsT {
+        std::array<uint64_t, 8> m_words{};
+
+    public:
+        void set(const codeT code) { m_words[code >> 6] |= uint64_t(1) << (code & 63); }
+        bool test(const codeT code) const { return (m_words[code >> 6] >> (code & 63)) & 1; }
+        bool all() const {
+            return std::ranges::all_of(m_words, [](const uint64_t word) { return word == ~uint64_t(0); });
+        }
+
+        // Set `lock[code]` for each code in the set.
+        void merge_into(lockT& lock) const {
+            for_each_code([&](const codeT code) {
+                if (test(code)) {
+                    lock[code] = true;
+                }
+            });
+        }
+
+        friend bool operator==(const code_bitsT&, const code_bitsT&) = default;
+    };
+
+    namespace _misc {
+        // (With `record`, the codes are also set in `invoked`, which costs nothing otherwise.)
+        template <bool record>
+        inline void apply_rule_impl(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source,
+                                    const border_const_ref source_border, char* const vec_p6,
+                                    [[maybe_unused]] code_bitsT* const invoked) {
+            assert(source.size == dest.size);
+            assert(source.size == source_border.size);
+            const vecT size = source.size;
+
+            {
+                const bool *const up = source_border.up_line(), *cn = source.line(0);
+                const auto [up_l, up_r] = source_border.get_lr(-1);
+                const auto [cn_l, cn_r] = source_border.get_lr(0);
+                int p3_up = (up_l << 1) | up[0];
+                int p3_cn = (cn_l << 1) | cn[0];
+                for (int x = 0; x < size.x - 1; ++x) {
+                    // ~ "arbitrary-signed-int << bits" is made well-defined in C++20.
+                    p3_up = (p3_up << 1) | up[x + 1]; // ... | (up[x - 1] << 2) | (up[x] << 1) | up[x + 1]
+                    p3_cn = (p3_cn << 1) | cn[x + 1]; // ... | (cn[x - 1] << 2) | (cn[x] << 1) | cn[x + 1]
+                    vec_p6[x] = (p3_up << 3) | (p3_cn & 0b111);
+                }
+                p3_up = (p3_up << 1) | up_r;
+                p3_cn = (p3_cn << 1) | cn_r;
+                vec_p6[size.x - 1] = (p3_up << 3) | (p3_cn & 0b111);
+            }
+
+            for (int y = 0; y < size.y; ++y) {
+                bool* const dest_ = dest.line(y);
+                const bool* const dw = y == size.y - 1 ? source_border.down_line() : source.line(y + 1);
+                const auto [dw_l, dw_r] = source_border.get_lr(y + 1);
+                int p3_dw = (dw_l << 1) | dw[0];
+                for (int x = 0; x < size.x - 1; ++x) {
+                    p3_dw = (p3_dw << 1) | dw[x + 1]; // ... | (dw[x - 1] << 2) | (dw[x] << 1) | dw[x + 1]
+                    const int code = ((vec_p6[x] << 3) | (p3_dw & 0b111)) & 0b111'111'111;
+                    if constexpr (record) {
+                        invoked->set(codeT{code});
+                    }
+                    dest_[x] = rule(codeT{code});
+                    vec_p6[x] = code;
+                }
+                p3_dw = (p3_dw << 1) | dw_r;
+                const int code = ((vec_p6[size.x - 1] << 3) | (p3_dw & 0b111)) & 0b111'111'111;
+                if constexpr (record) {
+                    invoked->set(codeT{code});
+                }
+                dest_[size.x - 1] = rule(codeT{code});
+                vec_p6[size.x - 1] = code;
+            }
+        }
+    } // namespace _misc
+
     // Relying on codeT::bpos_q = 8, bpos_w = 7, ... bpos_c = 0.
     // `dest` and `source` may either refer to the same area, or completely non-overlapping.
+    // (`vec_p6` is the scratch buffer of `source.size.x` chars.)
     inline void apply_rule(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source,
-                           const border_const_ref source_border) {
-        assert(source.size == dest.size);
-        assert(source.size == source_border.size);
-        const vecT size = source.size;
+                           const border_const_ref source_border, char* const vec_p6) {
+        _misc::apply_rule_impl<false>(rule, dest, source, source_border, vec_p6, nullptr);
+    }
 
-        const auto vec_p6_data = std::make_unique_for_overwrite<char[]>(size.x);
-        char* const vec_p6 = vec_p6_data.get();
-        {
-            const bool *const up = source_border.up_line(), *cn = source.line(0);
-            const auto [up_l, up_r] = source_border.get_lr(-1);
-            const auto [cn_l, cn_r] = source_border.get_lr(0);
-            int p3_up = (up_l << 1) | up[0];
-            int p3_cn = (cn_l << 1) | cn[0];
-            for (int x = 0; x < size.x - 1; ++x) {
-                // ~ "arbitrary-signed-int << bits" is made well-defined in C++20.
-                p3_up = (p3_up << 1) | up[x + 1]; // ... | (up[x - 1] << 2) | (up[x] << 1) | up[x + 1]
-                p3_cn = (p3_cn << 1) | cn[x + 1]; // ... | (cn[x - 1] << 2) | (cn[x] << 1) | cn[x + 1]
-                vec_p6[x] = (p3_up << 3) | (p3_cn & 0b111);
-            }
-            p3_up = (p3_up << 1) | up_r;
-            p3_cn = (p3_cn << 1) | cn_r;
-            vec_p6[size.x - 1] = (p3_up << 3) | (p3_cn & 0b111);
-        }
-
-        for (int y = 0; y < size.y; ++y) {
-            bool* const dest_ = dest.line(y);
-            const bool* const dw = y == size.y - 1 ? source_border.down_line() : source.line(y + 1);
-            const auto [dw_l, dw_r] = source_border.get_lr(y + 1);
-            int p3_dw = (dw_l << 1) | dw[0];
-            for (int x = 0; x < size.x - 1; ++x) {
-                p3_dw = (p3_dw << 1) | dw[x + 1]; // ... | (dw[x - 1] << 2) | (dw[x] << 1) | dw[x + 1]
-                const int code = ((vec_p6[x] << 3) | (p3_dw & 0b111)) & 0b111'111'111;
-                dest_[x] = rule(codeT{code});
-                vec_p6[x] = code;
-            }
-            p3_dw = (p3_dw << 1) | dw_r;
-            const int code = ((vec_p6[size.x - 1] << 3) | (p3_dw & 0b111)) & 0b111'111'111;
-            dest_[size.x - 1] = rule(codeT{code});
-            vec_p6[size.x - 1] = code;
-        }
+    // The same as above, and also record the invoked codes in `invoked` in the same pass.
+    inline void apply_rule(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source,
+                           const border_const_ref source_border, char* const vec_p6, code_bitsT& invoked) {
+        _misc::apply_rule_impl<true>(rule, dest, source, source_border, vec_p6, &invoked);
+    }
+
+    inline void apply_rule(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source,
+                           const border_const_ref source_border) {
+        const auto vec_p6_data = std::make_unique_for_overwrite<char[]>(source.size.x);
+        apply_rule(rule, dest, source, source_border, vec_p6_data.get());
     }
 
     inline void apply_rule_torus(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source) {
@@ -647,23 +856,201 @@ namespace aniso {
         apply_rule_torus(rule, tile, tile);
     }
 
+    // Keeps the scratch buffers for `apply_rule_torus`, so that repeated stepping doesn't allocate.
+    // (The tile is updated in place; `apply_rule` already keeps the old lines it needs in `vec_p6`.)
+    class torus_stepperT {
+        vecT m_size{};
+        std::unique_ptr<char[]> m_vec_p6{};
+        std::unique_ptr<bool[]> m_border{};
+        int m_alloc_count = 0;
+
+        void prepare(const vecT size) {
+            if (m_size != size) {
+                m_size = size;
+                m_vec_p6 = std::make_unique_for_overwrite<char[]>(m_size.x);
+                m_border = std::make_unique_for_overwrite<bool[]>(calc_border_size(m_size));
+                ++m_alloc_count;
+            }
+        }
+
+    public:
+        // Times the buffers are (re)allocated, which happens only when the tile size changes.
+        int alloc_count() const { return m_alloc_count; }
+
+        // The same as calling `apply_rule_torus(rule, tile)` `count` times.
+        void run_torus(const rule_like auto& rule, const tile_ref tile, const int count) {
+            prepare(tile.size);
+            const border_ref border{.size = m_size, .data = m_border.get()};
+            for (int c = 0; c < count; ++c) {
+                border.collect_from(tile, tile, tile, tile, tile, tile, tile, tile);
+                apply_rule(rule, tile, tile, border, m_vec_p6.get());
+            }
+        }
+
+        // The same as above, and also record the invoked codes in `invoked`.
+        void run_torus(const rule_like auto& rule, const tile_ref tile, const int count, code_bitsT& invoked) {
+            prepare(tile.size);
+            const border_ref border{.size = m_size, .data = m_border.get()};
+            for (int c = 0; c < count; ++c) {
+                border.collect_from(tile, tile, tile, tile, tile, tile, tile, tile);
+                apply_rule(rule, tile, tile, border, m_vec_p6.get(), invoked);
+            }
+        }
+    };
+
+    // Temporal blocking: the torus is divided into blocks, and each block (with a halo `gens` cells wide) is
+    // advanced `gens` generations at once, so the data stays in cache for all these generations.
+    namespace _misc {
+        // Copy the area of `dest.size` starting at `begin` (wrapped) in the torus space.
+        inline void copy_wrapped(const tile_ref dest, const tile_const_ref source, const vecT begin) {
+            const auto mod = [](int a, int r) { return ((a % r) + r) % r; };
+            wrapped_int sy(mod(begin.y, source.size.y), source.size.y);
+            for (int y = 0; y < dest.size.y; ++y) {
+                const bool* const src = source.line(sy++);
+                bool* const dest_ = dest.line(y);
+                for (int x = 0, sx = mod(begin.x, source.size.x); x < dest.size.x; sx = 0) {
+                    const int n = std::min(dest.size.x - x, source.size.x - sx);
+                    std::copy_n(src + sx, n, dest_ + x);
+                    x += n;
+                }
+            }
+        }
+
+        class blocked_stepperT {
+            int m_gens, m_block;
+            std::unique_ptr<bool[]> m_data;   // Two buffers + border.
+            std::unique_ptr<char[]> m_vec_p6; // Scratch for `apply_rule`.
+
+        public:
+            // Each buffer holds (block + 2 * max_gens)^2 cells.
+            blocked_stepperT(int max_gens, int block)
+                : m_gens{max_gens}, m_block{block},
+                  m_data{std::make_unique_for_overwrite<bool[]>(
+                      2 * (block + 2 * max_gens) * (block + 2 * max_gens) +
+                      calc_border_size({block + 2 * max_gens, block + 2 * max_gens}))},
+                  m_vec_p6{std::make_unique_for_overwrite<char[]>(block + 2 * max_gens)} {
+                assert(max_gens >= 1 && block >= 1);
+            }
+
+            int max_gens() const { return m_gens; }
+            int block() const { return m_block; }
+
+            // Advance the cells in `range` (at most `block` wide) by `gens` (at most `max_gens`) generations into
+            // `dest`. (`dest` and `source` should not overlap.)
+            void step(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source,
+                      const rangeT& range, const int gens) {
+                assert(dest.size == range.size() && range.size().both_lteq({m_block, m_block}));
+                assert(gens >= 1 && gens <= m_gens);
+                const int buf_size = (m_block + 2 * m_gens) * (m_block + 2 * m_gens);
+                bool* a_data = m_data.get();
+                bool* b_data = a_data + buf_size;
+                bool* const border_data = b_data + buf_size;
+
+                vecT size = range.size().plus(2 * gens, 2 * gens);
+                copy_wrapped({a_data, size}, source, range.begin.plus(-gens, -gens));
+                for (int g = 0; g < gens; ++g) {
+                    // The outermost ring serves as the border, so the valid area shrinks by 1 at each side.
+                    const tile_const_ref a{a_data, size};
+                    const vecT inner = size.plus(-2, -2);
+                    const border_ref border{.size = inner, .data = border_data};
+                    const auto part = [&](int x0, int y0, int x1, int y1) { return a.clip({{x0, y0}, {x1, y1}}); };
+                    const int w = size.x, h = size.y;
+                    border.collect_from(part(0, 0, 1, 1), part(1, 0, w - 1, 1), part(w - 1, 0, w, 1), //
+                                        part(0, 1, 1, h - 1), /*              s                 */ part(w - 1, 1, w, h - 1),
+                                        part(0, h - 1, 1, h), part(1, h - 1, w - 1, h), part(w - 1, h - 1, w, h));
+                    apply_rule(rule, tile_ref{b_data, inner}, part(1, 1, w - 1, h - 1), border, m_vec_p6.get());
+                    std::swap(a_data, b_data);
+                    size = inner;
+                }
+                assert(size == dest.size);
+                copy(dest, tile_const_ref{a_data, size});
+            }
+        };
+    } // namespace _misc
+
+    namespace _misc {
+        inline void apply_rule_torus_blocked(const rule_like auto& rule, const tile_ref dest,
+                                             const tile_const_ref source, const int gens,
+                                             blocked_stepperT& stepper) {
+            const int block = stepper.block();
+            for (int y = 0; y < source.size.y; y += block) {
+                for (int x = 0; x < source.size.x; x += block) {
+                    const rangeT range{{x, y}, min(source.size, {x + block, y + block})};
+                    stepper.step(rule, dest.clip(range), source, range, gens);
+                }
+            }
+        }
+    } // namespace _misc
+
+    // The same as calling `apply_rule_torus(rule, tile)` `gens` times.
+    // (`dest` and `source` should not overlap.)
+    inline void apply_rule_torus_blocked(const rule_like auto& rule, const tile_ref dest, const tile_const_ref source,
+                                         const int gens, const int block = 256) {
+        assert(source.size == dest.size);
+        _misc::blocked_stepperT stepper(gens, block);
+        _misc::apply_rule_torus_blocked(rule, dest, source, gens, stepper);
+    }
+
+    // Keeps the buffers for `apply_rule_torus_blocked`, so that repeated stepping doesn't allocate.
+    class blocked_torus_stepperT {
+        static constexpr int max_gens = 8; // (Wider halos cost more than they save.)
+        vecT m_size{};
+        std::unique_ptr<bool[]> m_temp{};
+        _misc::blocked_stepperT m_stepper{max_gens, 256};
+        int m_alloc_count = 0;
+
+        void prepare(const vecT size) {
+            if (m_size != size) {
+                m_size = size;
+                m_temp = std::make_unique_for_overwrite<bool[]>(m_size.xy());
+                ++m_alloc_count;
+            }
+        }
+
+    public:
+        // Times the temp tile is (re)allocated, which happens only when the tile size changes.
+        int alloc_count() const { return m_alloc_count; }
+
+        // The same as calling `apply_rule_torus(rule, tile)` `count` times.
+        void run_torus(const rule_like auto& rule, const tile_ref tile, int count) {
+            if (count <= 0) {
+                return;
+            }
+            prepare(tile.size);
+            tile_ref a = tile, b{m_temp.get(), m_size}; // (Ping-pong.)
+            while (count > 0) {
+                const int gens = std::min(count, max_gens);
+                _misc::apply_rule_torus_blocked(rule, b, a, gens, m_stepper);
+                std::swap(a, b);
+                count -= gens;
+            }
+            if (a.data != tile.data) {
+                copy(tile, a);
+            }
+        }
+    };
+
+    // Record the codes of the cells not at the edge, without calculating the next generation.
+    // (The codes are rolled along the lines as in `apply_rule`, instead of being encoded cell by cell.)
     inline void fake_apply(const tile_const_ref tile, lockT& lock) {
         if (tile.size.x <= 2 || tile.size.y <= 2) {
             return;
         }
 
+        code_bitsT invoked{};
         for (int y = 1; y < tile.size.y - 1; ++y) {
             const bool* const up = tile.line(y - 1);
             const bool* const cn = tile.line(y);
             const bool* const dw = tile.line(y + 1);
+            int p3_up = (up[0] << 1) | up[1], p3_cn = (cn[0] << 1) | cn[1], p3_dw = (dw[0] << 1) | dw[1];
             for (int x = 1; x < tile.size.x - 1; ++x) {
-                lock[encode({
-                    up[x - 1], up[x], up[x + 1], //
-                    cn[x - 1], cn[x], cn[x + 1], //
-                    dw[x - 1], dw[x], dw[x + 1], //
-                })] = true;
+                p3_up = (p3_up << 1) | up[x + 1];
+                p3_cn = (p3_cn << 1) | cn[x + 1];
+                p3_dw = (p3_dw << 1) | dw[x + 1];
+                invoked.set(codeT{((p3_up & 0b111) << 6) | ((p3_cn & 0b111) << 3) | (p3_dw & 0b111)});
             }
         }
+        invoked.merge_into(lock);
     }
 
 #ifdef ENABLE_TESTS
@@ -685,6 +1072,22 @@ namespace aniso {
             });
         };
 
+        inline const testT test_apply_blocked = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            for (const vecT size : {vecT{1, 1}, vecT{3, 7}, vecT{40, 30}, vecT{70, 9}}) {
+                const auto data = std::make_unique<bool[]>(size.xy() * 2);
+                const tile_ref a{data.get(), size}, b{data.get() + size.xy(), size};
+                random_fill(a, testT::rand, 0.5);
+                for (const int gens : {1, 2, 5}) {
+                    apply_rule_torus_blocked(rule, b, a, gens, 16);
+                    for (int g = 0; g < gens; ++g) {
+                        apply_rule_torus(rule, a);
+                    }
+                    assert(std::equal(a.data, a.data + size.xy(), b.data));
+                }
+            }
+        };
+
         inline const testT test_apply_2 = [] {
             const ruleT copy_q = make_rule([](codeT c) { return c.get(codeT::bpos_q); });
 
@@ -699,6 +1102,82 @@ namespace aniso {
                 assert(data[0] == data[1]);
             }
         };
+
+        inline const testT test_torus_stepper = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            torus_stepperT stepper;
+            int allocs = 0;
+            for (const vecT size : {vecT{1, 1}, vecT{9, 4}, vecT{9, 4}, vecT{33, 20}}) {
+                const auto data = std::make_unique<bool[]>(size.xy() * 2);
+                const tile_ref a{data.get(), size}, b{data.get() + size.xy(), size};
+                random_fill(a, testT::rand, 0.5);
+                copy(b, a);
+                for (const int count : {0, 1, 5}) {
+                    stepper.run_torus(rule, a, count);
+                    for (int c = 0; c < count; ++c) {
+                        apply_rule_torus(rule, b);
+                    }
+                    assert(std::equal(a.data, a.data + size.xy(), b.data));
+                }
+                allocs = stepper.alloc_count();
+            }
+            assert(allocs == 3);
+        };
+
+        inline const testT test_blocked_torus_stepper = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            blocked_torus_stepperT stepper;
+            int allocs = 0;
+            for (const vecT size : {vecT{3, 7}, vecT{300, 20}, vecT{300, 20}, vecT{40, 270}}) {
+                const auto data = std::make_unique<bool[]>(size.xy() * 2);
+                const tile_ref a{data.get(), size}, b{data.get() + size.xy(), size};
+                random_fill(a, testT::rand, 0.5);
+                copy(b, a);
+                for (const int count : {0, 1, 8, 13}) {
+                    stepper.run_torus(rule, a, count);
+                    for (int c = 0; c < count; ++c) {
+                        apply_rule_torus(rule, b);
+                    }
+                    assert(std::equal(a.data, a.data + size.xy(), b.data));
+                }
+                allocs = stepper.alloc_count();
+            }
+            assert(allocs == 3);
+        };
+
+        inline const testT test_record_invoked = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            const vecT size{.x = int(testT::rand() % 20) + 3, .y = int(testT::rand() % 20) + 3};
+            const auto data = std::make_unique_for_overwrite<bool[]>(size.xy() * 2);
+            const tile_ref a{data.get(), size}, b{data.get() + size.xy(), size};
+            random_fill(a, testT::rand, 0.5);
+            copy(b, a);
+
+            lockT inner{}, fake{}, torus{};
+            torus_stepperT stepper;
+            code_bitsT invoked{};
+            for (int g = 0; g < 4; ++g) {
+                for (int y = 1; y < size.y - 1; ++y) {
+                    for (int x = 1; x < size.x - 1; ++x) {
+                        inner[encode({a.at(x - 1, y - 1), a.at(x, y - 1), a.at(x + 1, y - 1), //
+                                         a.at(x - 1, y), a.at(x, y), a.at(x + 1, y),             //
+                                         a.at(x - 1, y + 1), a.at(x, y + 1), a.at(x + 1, y + 1)})] = true;
+                    }
+                }
+                fake_apply(a, fake);
+                assert(fake == inner);
+
+                apply_rule_torus(
+                    [&](codeT code) {
+                        torus[code] = true;
+                        return rule[code];
+                    },
+                    a);
+                stepper.run_torus(rule, b, 1, invoked);
+                assert(std::equal(a.data, a.data + size.xy(), b.data));
+                for_each_code([&](codeT code) { assert(invoked.test(code) == torus[code]); });
+            }
+        };
     } // namespace _tests
 #endif // ENABLE_TESTS
 
@@ -768,6 +1247,19 @@ namespace aniso {
             apply_rule_torus(rule, data());
         }
 
+        enum class engineE { Plain, Blocked };
+
+        void run_torus(const rule_like auto& rule, int count, const engineE engine) {
+            if (engine == engineE::Plain) {
+                if (count > 0) {
+                    torus_stepperT().run_torus(rule, data(), count);
+                }
+                return;
+            }
+
+            blocked_torus_stepperT().run_torus(rule, data(), count);
+        }
+
         friend bool operator==(const tileT& a, const tileT& b) {
             if (a.m_size != b.m_size) {
                 return false;
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "tile_parallel.hpp"
+
+namespace aniso {
+    // Torus stepping that skips quiescent blocks.
+    // If a block and its 8 neighbors are the same at generation t and t - 2, the block at t + 1 must be the same
+    // as at t - 1, so it's copied instead of recalculated. (Comparing with t - 2 instead of t - 1 makes the
+    // strobing backgrounds and period-2 oscillators quiescent as well.)
+    class active_stepperT {
+        static constexpr int block_size = 32;
+        static constexpr int border_size = calc_border_size({block_size, block_size});
+
+        std::vector<char> m_dirty{};  // Whether the block at t differs from t - 2.
+        std::vector<char> m_recalc{}; // (Temporary) whether to recalculate the block.
+        tileT m_prev{}, m_next{};     // t - 1, (to be written).
+        int m_history = 0;            // Generations since `reset` (up to 2).
+        double m_ratio = 1;           // Portion of the blocks recalculated in the last step.
+
+        // Scratch for `apply_rule`, one part for each line of blocks (as they are run concurrently).
+        std::unique_ptr<bool[]> m_borders{};
+        std::unique_ptr<char[]> m_vec_p6{};
+
+        rangeT block_range(const vecT size, const int bx, const int by) const {
+            return {{bx * block_size, by * block_size},
+                    min(size, {(bx + 1) * block_size, (by + 1) * block_size})};
+        }
+
+    public:
+        // Should be called whenever the torus is changed outside of `step`.
+        void reset() { m_history = 0; }
+
+        // Whether `active_ratio` reflects the actual activity.
+        bool measured() const { return m_history >= 2; }
+        double active_ratio() const { return m_ratio; }
+
+        void step(const rule_like auto& rule, worker_poolT& pool, tileT& torus) {
+            const vecT size = torus.size();
+            const vecT blocks{(size.x + block_size - 1) / block_size, (size.y + block_size - 1) / block_size};
+            if (m_prev.size() != size) {
+                m_prev.resize(size);
+                m_next.resize(size);
+                m_dirty.assign(blocks.xy(), true);
+                m_recalc.assign(blocks.xy(), true);
+                m_borders = std::make_unique_for_overwrite<bool[]>(blocks.y * border_size);
+                m_vec_p6 = std::make_unique_for_overwrite<char[]>(blocks.y * block_size);
+                m_history = 0;
+            }
+            if (m_history < 2) {
+                std::ranges::fill(m_dirty, true);
+            }
+
+            const auto wrap = [](int v, int r) { return v < 0 ? v + r : v >= r ? v - r : v; };
+            int recalc_count = 0;
+            for (int by = 0; by < blocks.y; ++by) {
+                for (int bx = 0; bx < blocks.x; ++bx) {
+                    bool recalc = false;
+                    for (int dy = -1; dy <= 1 && !recalc; ++dy) {
+                        for (int dx = -1; dx <= 1 && !recalc; ++dx) {
+                            recalc = m_dirty[wrap(by + dy, blocks.y) * blocks.x + wrap(bx + dx, blocks.x)];
+                        }
+                    }
+                    m_recalc[by * blocks.x + bx] = recalc;
+                    recalc_count += recalc;
+                }
+            }
+            m_ratio = double(recalc_count) / blocks.xy();
+
+            // Each task deals with a line of blocks.
+            const tile_const_ref source = torus.data(), prev = m_prev.data();
+            const tile_ref dest = m_next.data();
+            const bool compare = m_history >= 1; // Whether `m_prev` is valid.
+            pool.run(blocks.y, [&](const int by) {
+                bool* const border_data = m_borders.get() + by * border_size;
+                char* const vec_p6 = m_vec_p6.get() + by * block_size;
+                for (int bx = 0; bx < blocks.x; ++bx) {
+                    const rangeT range = block_range(size, bx, by);
+                    char& dirty = m_dirty[by * blocks.x + bx];
+                    if (!m_recalc[by * blocks.x + bx]) {
+                        copy(dest.clip(range), prev.clip(range));
+                        dirty = false;
+                        continue;
+                    }
+                    const border_ref border{.size = range.size(), .data = border_data};
+                    _misc::collect_torus_border(border, source, range);
+                    apply_rule(rule, dest.clip(range), source.clip(range), border, vec_p6);
+                    dirty = !compare || count_diff(dest.clip(range), prev.clip(range)) != 0;
+                }
+            });
+
+            // (t - 1, t, t + 1) -> (t, t + 1, to be written)
+            m_prev.swap(torus);
+            torus.swap(m_next);
+            m_history = std::min(m_history + 1, 2);
+        }
+    };
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_active_stepper = [] {
+            worker_poolT pool(3);
+            const ruleT rules[]{game_of_life(), make_rule([](codeT) { return testT::rand() & 1; }),
+                                make_rule([](codeT c) { return !c.get(codeT::bpos_s); })};
+            for (const ruleT& rule : rules) {
+                for (const vecT size : {vecT{1, 1}, vecT{31, 33}, vecT{100, 70}}) {
+                    tileT tile(size), compare(size);
+                    // Mostly quiescent.
+                    random_fill(tile.data().clip({{0, 0}, min(size, {12, 9})}), testT::rand, 0.5);
+                    copy(compare.data(), tile.data());
+
+                    active_stepperT stepper;
+                    for (int g = 0; g < 40; ++g) {
+                        if (g == 20) {
+                            random_flip(tile.data(), testT::rand, 0.01);
+                            copy(compare.data(), tile.data());
+                            stepper.reset();
+                        }
+                        stepper.step(rule, pool, tile);
+                        compare.run_torus(rule);
+                        assert(tile == compare);
+                    }
+                }
+            }
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "rule_algo.hpp"
+#include "tile_parallel.hpp"
+
+namespace aniso {
+    // Circuits for the totalistic rules (native, hexagonal and von-Neumann), which depend only on `s` and the
+    // number of the neighbors. The count is summed by bit-sliced adders, and the circuit is built for the count
+    // bits and `s`, which is much smaller than the one for the 9 inputs.
+    // (Other rules in the hexagonal and von-Neumann families need no special treatment, as `circuitT` already
+    // skips the inputs a rule doesn't depend on.)
+    class family_kernelT {
+    public:
+        enum class familyE { Any, Tot, HexTot, VonTot };
+
+        static familyE detect(const ruleT& rule) {
+            static const subsetT tot = make_subset({mp_C8, mp_tot_exc_s});
+            static const subsetT hex_tot = make_subset({mp_hex_C6, mp_hex_tot_exc_s});
+            static const subsetT von_tot = make_subset({mp_von_ignore, mp_C4, mp_von_tot_exc_s});
+            return tot.contains(rule)       ? familyE::Tot
+                   : hex_tot.contains(rule) ? familyE::HexTot
+                   : von_tot.contains(rule) ? familyE::VonTot
+                                            : familyE::Any;
+        }
+
+    private:
+        familyE m_family;
+        circuitT m_circuit;
+
+        // (count, s) -> the value, with the count bits as q (1), w (2), e (4) and a (8).
+        static ruleT count_rule(const ruleT& rule, const familyE family) {
+            using enum codeT::bposE;
+            static constexpr codeT::bposE native[]{bpos_q, bpos_w, bpos_e, bpos_a, bpos_d, bpos_z, bpos_x, bpos_c};
+            static constexpr codeT::bposE hex[]{bpos_q, bpos_w, bpos_a, bpos_d, bpos_x, bpos_c};
+            static constexpr codeT::bposE von[]{bpos_w, bpos_a, bpos_d, bpos_x};
+            using spanT = std::span<const codeT::bposE>;
+            const spanT neighbors = family == familyE::Tot      ? spanT(native)
+                                    : family == familyE::HexTot ? spanT(hex)
+                                                                : spanT(von);
+            return make_rule([&](const codeT code) {
+                const int count = code.get(bpos_q) | (code.get(bpos_w) << 1) | (code.get(bpos_e) << 2) |
+                                  (code.get(bpos_a) << 3);
+                if (count > int(neighbors.size())) {
+                    return false;
+                }
+                int example = code.get(bpos_s) << bpos_s; // (Any `count` neighbors.)
+                for (int n = 0; n < count; ++n) {
+                    example |= 1 << neighbors[n];
+                }
+                return rule[codeT{example}];
+            });
+        }
+
+    public:
+        explicit family_kernelT(const ruleT& rule)
+            : m_family{detect(rule)}, m_circuit{m_family == familyE::Any ? rule : count_rule(rule, m_family)} {}
+
+        familyE family() const { return m_family; }
+        const circuitT& circuit() const { return m_circuit; }
+        circuitT& circuit() { return m_circuit; } // (E.g. to set the runner.)
+    };
+
+    namespace _misc {
+        template <family_kernelT::familyE family>
+        struct gather_familyT {
+            template <int lanes>
+            static void gather(uint64_t* const nodes, const int l, const uint64_t* const up, const uint64_t* const cn,
+                               const uint64_t* const dw, const int i) {
+                using enum codeT::bposE;
+                using enum family_kernelT::familyE;
+                const auto at = [i](const uint64_t* line, int dx) { // Cells (x + dx - 1) for the 64 cells at i.
+                    return dx == 0 ? line[i] : (line[i] >> dx) | (line[i + 1] << (64 - dx));
+                };
+                const auto set = [&](int bpos, uint64_t word) { nodes[bpos * lanes + l] = word; };
+                const auto full_add = [](uint64_t a, uint64_t b, uint64_t c) {
+                    return std::pair{a ^ b ^ c, (a & b) | (c & (a ^ b))};
+                };
+                const auto set_count = [&](uint64_t b0, uint64_t b1, uint64_t b2, uint64_t b3) {
+                    set(bpos_q, b0), set(bpos_w, b1), set(bpos_e, b2), set(bpos_a, b3);
+                    set(bpos_s, at(cn, 1));
+                };
+                if constexpr (family == Tot) {
+                    const auto [s1, c1] = full_add(at(up, 0), at(up, 1), at(up, 2));
+                    const auto [s2, c2] = full_add(at(cn, 0), at(cn, 2), at(dw, 0));
+                    const uint64_t x = at(dw, 1), c = at(dw, 2);
+                    const auto [b0, c3] = full_add(s1, s2, x ^ c);
+                    const auto [t0, t1] = full_add(c1, c2, x & c);
+                    const uint64_t t2 = t0 & c3;
+                    set_count(b0, t0 ^ c3, t1 ^ t2, t1 & t2);
+                } else if constexpr (family == HexTot) {
+                    const auto [s1, c1] = full_add(at(up, 0), at(up, 1), at(cn, 0));
+                    const auto [s2, c2] = full_add(at(cn, 2), at(dw, 1), at(dw, 2));
+                    const auto [b1, b2] = full_add(c1, c2, s1 & s2);
+                    set_count(s1 ^ s2, b1, b2, 0);
+                } else {
+                    static_assert(family == VonTot);
+                    const auto [s1, c1] = full_add(at(up, 1), at(cn, 0), at(cn, 2));
+                    const uint64_t x = at(dw, 1);
+                    set_count(s1 ^ x, c1 ^ (s1 & x), c1 & s1 & x, 0);
+                }
+            }
+        };
+    } // namespace _misc
+
+    inline void apply_rule_torus(const family_kernelT& kernel, packed_tileT& dest, const packed_tileT& source,
+                                 const int y_begin, const int y_end, packed_scratchT& scratch) {
+        using enum family_kernelT::familyE;
+        const circuitT& circuit = kernel.circuit();
+        switch (kernel.family()) {
+            case Tot:
+                _misc::apply_circuit<_misc::gather_familyT<Tot>>(circuit, dest, source, y_begin, y_end, scratch);
+                break;
+            case HexTot:
+                _misc::apply_circuit<_misc::gather_familyT<HexTot>>(circuit, dest, source, y_begin, y_end, scratch);
+                break;
+            case VonTot:
+                _misc::apply_circuit<_misc::gather_familyT<VonTot>>(circuit, dest, source, y_begin, y_end, scratch);
+                break;
+            default: assert(kernel.family() == Any); apply_rule_torus(circuit, dest, source, y_begin, y_end, scratch);
+        }
+    }
+
+    // (With temporary scratch; for repeated stepping `banded_stepperT` should be kept instead.)
+    inline void apply_rule_torus(const family_kernelT& kernel, worker_poolT& pool, packed_tileT& dest,
+                                 const packed_tileT& source) {
+        banded_stepperT().run(kernel, pool, dest, source);
+    }
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_family_kernel = [] {
+            using enum family_kernelT::familyE;
+            const auto test = [](const ruleT& rule, const family_kernelT::familyE family) {
+                const family_kernelT kernel(rule);
+                assert(kernel.family() == family);
+                worker_poolT pool(2);
+                banded_stepperT stepper;
+                for (const vecT size : {vecT{1, 1}, vecT{3, 5}, vecT{64, 3}, vecT{130, 40}}) {
+                    tileT tile(size), compare(size);
+                    random_fill(tile.data(), testT::rand, 0.5);
+                    packed_tileT p(size), p2(size);
+                    copy(p, tile.data());
+                    int allocs = 0;
+                    for (int g = 0; g < 3; ++g) {
+                        tile.run_torus(rule);
+                        stepper.run(kernel, pool, p2, p);
+                        p.swap(p2);
+                        copy(compare.data(), p);
+                        assert(tile == compare);
+                        if (g == 0) {
+                            allocs = stepper.alloc_count();
+                        } else {
+                            assert(stepper.alloc_count() == allocs); // (No allocation after the first step.)
+                        }
+                    }
+                }
+            };
+
+            using enum codeT::bposE;
+            // (Redrawn if the rule happens to be in a family checked earlier, e.g. a von-Neumann totalistic rule
+            // that doesn't depend on the count is also a native one.)
+            const auto test_random = [&](const subsetT& subset, const family_kernelT::familyE family) {
+                ruleT rule{};
+                do {
+                    rule = randomize_p(subset, mask_zero, testT::rand, 0.5);
+                } while (family_kernelT::detect(rule) != family);
+                test(rule, family);
+            };
+            test(game_of_life(), Tot);
+            test_random(make_subset({mp_C8, mp_tot_exc_s}), Tot);
+            test_random(make_subset({mp_C8, mp_tot_inc_s}), Tot);
+            test_random(make_subset({mp_von_ignore}), Any);
+            test_random(make_subset({mp_hex_ignore}), Any);
+            test_random(make_subset({mp_hex_C6, mp_hex_tot_exc_s}), HexTot);
+            test_random(make_subset({mp_hex_C6, mp_hex_tot_inc_s}), HexTot);
+            test_random(make_subset({mp_von_ignore, mp_C4, mp_von_tot_exc_s}), VonTot);
+            test_random(make_subset({mp_von_ignore, mp_C4, mp_von_tot_inc_s}), VonTot);
+            test(make_rule([](codeT c) { return c.get(bpos_e) && c.get(bpos_z); }), Any);
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
@@ -0,0 +1,641 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include "rule_circuit.hpp"
+#include "tile.hpp"
+
+namespace aniso {
+    // Bit-packed counterpart of `tileT`.
+    // Cell (x, y) is stored in bit (x % 64) of word (x / 64) of line y. The unused bits in the last word of
+    // each line are always 0, so that word-level operations (like `count`) need no extra masking.
+    class packed_tileT {
+        vecT m_size;
+        int m_stride;     // Number of words per line.
+        uint64_t* m_data; // [stride]*y
+
+    public:
+        static constexpr int calc_stride(const int width) { return (width + 63) / 64; }
+
+        bool empty() const {
+            assert((m_size.x == 0 && m_size.y == 0 && !m_data) || (m_size.x > 0 && m_size.y > 0 && m_data));
+            return m_size.x == 0;
+        }
+
+        packed_tileT() : m_size{}, m_stride{}, m_data{} {}
+
+        void swap(packed_tileT& other) noexcept {
+            std::swap(m_size, other.m_size);
+            std::swap(m_stride, other.m_stride);
+            std::swap(m_data, other.m_data);
+        }
+        packed_tileT(packed_tileT&& other) noexcept : m_size{}, m_stride{}, m_data{} { swap(other); }
+        packed_tileT& operator=(packed_tileT&& other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        explicit packed_tileT(const vecT size) : m_size{size}, m_stride{calc_stride(size.x)}, m_data{} {
+            assert((size.x == 0 && size.y == 0) || (size.x > 0 && size.y > 0));
+            if (m_size.x > 0) {
+                m_data = new uint64_t[m_stride * m_size.y]{};
+            }
+        }
+
+        ~packed_tileT() { delete[] m_data; }
+
+        packed_tileT(const packed_tileT& other) : m_size{other.m_size}, m_stride{other.m_stride}, m_data{} {
+            if (!other.empty()) {
+                m_data = new uint64_t[m_stride * m_size.y];
+                std::copy_n(other.m_data, m_stride * m_size.y, m_data);
+            }
+        }
+        packed_tileT& operator=(const packed_tileT&) = delete; // -> `= packed_tileT(other)`
+
+        void resize(const vecT size) {
+            if (m_size != size) {
+                packed_tileT(size).swap(*this);
+            }
+        }
+
+        vecT size() const { return m_size; }
+        int stride() const { return m_stride; }
+
+        uint64_t* line(int y) {
+            assert(!empty() && y >= 0 && y < m_size.y);
+            return m_data + m_stride * y;
+        }
+        const uint64_t* line(int y) const {
+            assert(!empty() && y >= 0 && y < m_size.y);
+            return m_data + m_stride * y;
+        }
+
+        // (All words, including the unused bits.)
+        std::span<uint64_t> words() {
+            assert(!empty());
+            return {m_data, size_t(m_stride * m_size.y)};
+        }
+        std::span<const uint64_t> words() const {
+            assert(!empty());
+            return {m_data, size_t(m_stride * m_size.y)};
+        }
+
+        // Mask for the used bits in the last word of each line.
+        uint64_t tail_mask() const {
+            assert(!empty());
+            const int r = m_size.x % 64;
+            return r == 0 ? ~uint64_t(0) : (uint64_t(1) << r) - 1;
+        }
+
+        bool get(int x, int y) const {
+            assert(x >= 0 && x < m_size.x);
+            return (line(y)[x / 64] >> (x % 64)) & 1;
+        }
+        void set(int x, int y, bool v) {
+            assert(x >= 0 && x < m_size.x);
+            uint64_t& word = line(y)[x / 64];
+            const uint64_t bit = uint64_t(1) << (x % 64);
+            word = v ? (word | bit) : (word & ~bit);
+        }
+
+        friend bool operator==(const packed_tileT& a, const packed_tileT& b) {
+            if (a.m_size != b.m_size) {
+                return false;
+            } else if (a.empty()) {
+                assert(b.empty());
+                return true;
+            } else {
+                return std::ranges::equal(a.words(), b.words());
+            }
+        }
+    };
+
+    namespace _misc {
+        // Every bit of the word is `v`.
+        inline uint64_t spread(const bool v) { return v ? ~uint64_t(0) : 0; }
+
+        // Repeat the first `p` bits of `bits` to fill a line of `width` cells.
+        // (`bits` is bound to x = 0; `p` <= 64.)
+        inline void fill_periodic(uint64_t* const line, const int width, const uint64_t bits, const int p) {
+            assert(p > 0 && p <= 64);
+            if (p == 1) {
+                std::fill_n(line, packed_tileT::calc_stride(width), spread(bits & 1));
+            } else {
+                for (int x = 0; x < width; ++x) {
+                    const uint64_t bit = uint64_t(1) << (x % 64);
+                    if (x % 64 == 0) {
+                        line[x / 64] = 0;
+                    }
+                    if ((bits >> (x % p)) & 1) {
+                        line[x / 64] |= bit;
+                    }
+                }
+            }
+            if (const int r = width % 64; r != 0) {
+                line[width / 64] &= (uint64_t(1) << r) - 1;
+            }
+        }
+    } // namespace _misc
+
+    // Packed versions of the helpers in "tile.hpp".
+    // (Unlike `tile_ref`, packed tiles are always processed as a whole.)
+
+    inline void copy(packed_tileT& dest, const tile_const_ref source) {
+        assert(dest.size() == source.size);
+        source.for_each_line([&dest](const int y, std::span<const bool> line) {
+            uint64_t* const dest_ = dest.line(y);
+            std::fill_n(dest_, dest.stride(), 0);
+            for (int x = 0; const bool b : line) {
+                dest_[x / 64] |= uint64_t(b) << (x % 64);
+                ++x;
+            }
+        });
+    }
+
+    inline void copy(const tile_ref dest, const packed_tileT& source) {
+        assert(dest.size == source.size());
+        dest.for_each_line([&source](const int y, std::span<bool> line) {
+            const uint64_t* const source_ = source.line(y);
+            for (int x = 0; bool& b : line) {
+                b = (source_[x / 64] >> (x % 64)) & 1;
+                ++x;
+            }
+        });
+    }
+
+    inline void copy(packed_tileT& dest, const packed_tileT& source) {
+        assert(dest.size() == source.size());
+        std::ranges::copy(source.words(), dest.words().begin());
+    }
+
+    inline void fill(packed_tileT& tile, const bool v) {
+        const uint64_t word = _misc::spread(v), tail = tile.tail_mask();
+        for (int y = 0; y < tile.size().y; ++y) {
+            uint64_t* const line = tile.line(y);
+            std::fill_n(line, tile.stride(), word);
+            line[tile.stride() - 1] &= tail;
+        }
+    }
+
+    // (`repeat.at(0, 0)` is bound to (0, 0) of the tile.)
+    inline void fill(packed_tileT& tile, const tile_const_ref repeat) {
+        assert(repeat.size.x <= 64);
+        for (int y = 0; y < tile.size().y; ++y) {
+            uint64_t bits = 0;
+            for (int x = 0; const bool b : std::span{repeat.line(y % repeat.size.y), size_t(repeat.size.x)}) {
+                bits |= uint64_t(b) << x++;
+            }
+            _misc::fill_periodic(tile.line(y), tile.size().x, bits, repeat.size.x);
+        }
+    }
+
+    template <blitE mode>
+    inline void blit(packed_tileT& dest, const packed_tileT& source) {
+        assert(dest.size() == source.size());
+        if constexpr (mode == blitE::Copy) {
+            copy(dest, source);
+        } else {
+            const std::span<const uint64_t> s = source.words();
+            const std::span<uint64_t> d = dest.words();
+            for (size_t i = 0; i < d.size(); ++i) {
+                if constexpr (mode == blitE::Or) {
+                    d[i] |= s[i];
+                } else if constexpr (mode == blitE::And) {
+                    d[i] &= s[i];
+                } else {
+                    static_assert(mode == blitE::Xor);
+                    d[i] ^= s[i];
+                }
+            }
+        }
+    }
+
+    inline int count(const packed_tileT& tile) {
+        int c = 0;
+        for (const uint64_t word : tile.words()) {
+            c += std::popcount(word);
+        }
+        return c;
+    }
+
+    inline rangeT bounding_box(const packed_tileT& tile, const bool background) {
+        const uint64_t bg = _misc::spread(background), tail = tile.tail_mask();
+        const int stride = tile.stride();
+        int min_x = INT_MAX, max_x = INT_MIN;
+        int min_y = INT_MAX, max_y = INT_MIN;
+        for (int y = 0; y < tile.size().y; ++y) {
+            const uint64_t* const line = tile.line(y);
+            const auto diff = [&](int i) { return (line[i] ^ bg) & (i == stride - 1 ? tail : ~uint64_t(0)); };
+
+            int i = 0;
+            while (i < stride && diff(i) == 0) {
+                ++i;
+            }
+            if (i == stride) {
+                continue;
+            }
+            min_x = std::min(min_x, i * 64 + std::countr_zero(diff(i)));
+            int j = stride - 1;
+            while (diff(j) == 0) {
+                --j;
+            }
+            max_x = std::max(max_x, j * 64 + 63 - std::countl_zero(diff(j)));
+            min_y = std::min(min_y, y);
+            max_y = y;
+        }
+        if (max_x != INT_MIN) {
+            return {.begin{.x = min_x, .y = min_y}, .end{.x = max_x + 1, .y = max_y + 1}};
+        } else {
+            return {};
+        }
+    }
+
+    namespace _misc {
+        // Line with one extra cell at each side (wrapped, as in torus space).
+        // Bit j of the result refers to cell (j - 1), so the 3 cells centered at x are at bits [x, x + 2].
+        // (`dest` should have `stride + 1` words.)
+        inline void make_wrapped_line(uint64_t* const dest, const uint64_t* const line, const int width) {
+            const int stride = packed_tileT::calc_stride(width);
+            uint64_t carry = (line[(width - 1) / 64] >> ((width - 1) % 64)) & 1; // Cell (width - 1).
+            for (int i = 0; i < stride; ++i) {
+                dest[i] = (line[i] << 1) | carry;
+                carry = line[i] >> 63;
+            }
+            dest[stride] = carry;
+            dest[(width + 1) / 64] |= (line[0] & 1) << ((width + 1) % 64); // Cell 0.
+        }
+
+        // Map the window taken from packed lines to `codeT`.
+        // In the window, bit 0/1/2 ~ q/w/e, 3/4/5 ~ a/s/d, 6/7/8 ~ z/x/c (x ascending in each line), which is
+        // the reverse of `codeT`'s bit order.
+        inline codeT::map_to<bool> make_window_table(const rule_like auto& rule) {
+            codeT::map_to<bool> table{};
+            for_each_code([&](const codeT window) {
+                int code = 0;
+                for (int b = 0; b < 9; ++b) {
+                    code |= ((window.val >> b) & 1) << (8 - b);
+                }
+                table[window] = rule(codeT{code});
+            });
+            return table;
+        }
+    } // namespace _misc
+
+    // Scratch for the packed kernels (wrapped lines etc.). It only grows, so that repeated stepping (of the same
+    // size) doesn't allocate. (Each band that is calculated concurrently should have its own scratch.)
+    class packed_scratchT {
+        std::unique_ptr<uint64_t[]> m_data{};
+        int m_size = 0;
+        int m_alloc_count = 0;
+
+    public:
+        // Times the buffer is (re)allocated.
+        int alloc_count() const { return m_alloc_count; }
+
+        uint64_t* reserve(const int words) {
+            if (m_size < words) {
+                m_size = words;
+                m_data = std::make_unique_for_overwrite<uint64_t[]>(m_size);
+                ++m_alloc_count;
+            }
+            return m_data.get();
+        }
+    };
+
+    // (`dest` and `source` should be different tiles.)
+    // Only lines [y_begin, y_end) of `dest` are updated, so disjoint bands can be calculated concurrently.
+    inline void apply_rule_torus(const rule_like auto& rule, packed_tileT& dest, const packed_tileT& source,
+                                 const int y_begin, const int y_end, packed_scratchT& scratch) {
+        assert(&dest != &source && dest.size() == source.size());
+        assert(0 <= y_begin && y_begin <= y_end && y_end <= source.size().y);
+        const vecT size = source.size();
+        const int stride = source.stride();
+        const codeT::map_to<bool> table = _misc::make_window_table(rule);
+
+        uint64_t* up = scratch.reserve(3 * (stride + 1));
+        uint64_t* cn = up + (stride + 1);
+        uint64_t* dw = cn + (stride + 1);
+        _misc::make_wrapped_line(up, source.line(y_begin == 0 ? size.y - 1 : y_begin - 1), size.x);
+        _misc::make_wrapped_line(cn, source.line(y_begin), size.x);
+
+        for (int y = y_begin; y < y_end; ++y) {
+            _misc::make_wrapped_line(dw, source.line(y + 1 == size.y ? 0 : y + 1), size.x);
+            uint64_t* const dest_ = dest.line(y);
+            for (int i = 0; i < stride; ++i) {
+                uint64_t u = up[i], c = cn[i], d = dw[i];
+                uint64_t word = 0;
+                const int n = std::min(64, size.x - i * 64);
+                for (int b = 0; b < n; ++b) {
+                    if (b == 62) { // Only 2 bits left in the current words.
+                        u |= up[i + 1] << 2, c |= cn[i + 1] << 2, d |= dw[i + 1] << 2;
+                    }
+                    const int window = (u & 0b111) | ((c & 0b111) << 3) | ((d & 0b111) << 6);
+                    word |= uint64_t(table[codeT{window}]) << b;
+                    u >>= 1, c >>= 1, d >>= 1;
+                }
+                dest_[i] = word;
+            }
+            std::swap(up, cn);
+            std::swap(cn, dw); // -> up, cn, (to be overwritten)
+        }
+    }
+
+    namespace _misc {
+        // Set the 9 neighbor planes as the inputs of the circuit.
+        struct gather_allT {
+            template <int lanes>
+            static void gather(uint64_t* const nodes, const int l, const uint64_t* const up, const uint64_t* const cn,
+                               const uint64_t* const dw, const int i) {
+                using enum codeT::bposE;
+                const auto set = [&](int bpos_0, int bpos_1, int bpos_2, const uint64_t* line) {
+                    nodes[bpos_0 * lanes + l] = line[i];
+                    nodes[bpos_1 * lanes + l] = (line[i] >> 1) | (line[i + 1] << 63);
+                    nodes[bpos_2 * lanes + l] = (line[i] >> 2) | (line[i + 1] << 62);
+                };
+                set(bpos_q, bpos_w, bpos_e, up);
+                set(bpos_a, bpos_s, bpos_d, cn);
+                set(bpos_z, bpos_x, bpos_c, dw);
+            }
+        };
+
+        // Evaluate the circuit for `lanes` words (64 * lanes cells) at a time; `gatherT::gather<lanes>` sets the
+        // inputs of lane `l` from word `i` of the wrapped lines.
+        template <class gatherT>
+        inline void apply_circuit(const circuitT& circuit, packed_tileT& dest, const packed_tileT& source,
+                                  const int y_begin, const int y_end, packed_scratchT& scratch) {
+            assert(&dest != &source && dest.size() == source.size());
+            assert(0 <= y_begin && y_begin <= y_end && y_end <= source.size().y);
+            constexpr int lanes = 16;
+            const vecT size = source.size();
+            const int stride = source.stride();
+            const uint64_t tail = source.tail_mask();
+
+            // 3 wrapped lines, and the nodes.
+            uint64_t* const nodes = scratch.reserve(circuit.node_count() * lanes + 3 * (stride + 1));
+            uint64_t* up = nodes + circuit.node_count() * lanes;
+            uint64_t* cn = up + (stride + 1);
+            uint64_t* dw = cn + (stride + 1);
+            make_wrapped_line(up, source.line(y_begin == 0 ? size.y - 1 : y_begin - 1), size.x);
+            make_wrapped_line(cn, source.line(y_begin), size.x);
+
+            for (int y = y_begin; y < y_end; ++y) {
+                make_wrapped_line(dw, source.line(y + 1 == size.y ? 0 : y + 1), size.x);
+                uint64_t* const dest_ = dest.line(y);
+                for (int i0 = 0; i0 < stride; i0 += lanes) {
+                    for (int l = 0; l < lanes; ++l) {
+                        const int i = std::min(i0 + l, stride - 1); // (Extra lanes are calculated but not used.)
+                        gatherT::template gather<lanes>(nodes, l, up, cn, dw, i);
+                    }
+                    const uint64_t* const out = circuit.run<lanes>(nodes);
+                    for (int l = 0; l < lanes && i0 + l < stride; ++l) {
+                        dest_[i0 + l] = out[l];
+                    }
+                }
+                dest_[stride - 1] &= tail;
+                std::swap(up, cn);
+                std::swap(cn, dw); // -> up, cn, (to be overwritten)
+            }
+        }
+    } // namespace _misc
+
+    inline void apply_rule_torus(const circuitT& circuit, packed_tileT& dest, const packed_tileT& source,
+                                 const int y_begin, const int y_end, packed_scratchT& scratch) {
+        _misc::apply_circuit<_misc::gather_allT>(circuit, dest, source, y_begin, y_end, scratch);
+    }
+
+    // The rule as a map from 4x4 windows to the 2x2 blocks in their center, so that a single lookup calculates
+    // 4 cells. (64KB, which fits in L2 cache.)
+    // In the window, bits [4 * r, 4 * r + 4) ~ line r (x ascending). In the result, bit 0/1 ~ upper-left/right,
+    // 2/3 ~ lower-left/right.
+    class block_tableT {
+        std::unique_ptr<uint8_t[]> m_table;
+
+    public:
+        explicit block_tableT(const rule_like auto& rule) : m_table{std::make_unique_for_overwrite<uint8_t[]>(65536)} {
+            const codeT::map_to<bool> table = _misc::make_window_table(rule);
+            for (int w = 0; w < 65536; ++w) {
+                const auto at = [w, &table](int x, int y) { // 3x3 window at (x, y) ~ `make_window_table`.
+                    int window = 0;
+                    for (int r = 0; r < 3; ++r) {
+                        window |= ((w >> (4 * (y + r) + x)) & 0b111) << (3 * r);
+                    }
+                    return int(table[codeT{window}]);
+                };
+                m_table[w] = at(0, 0) | (at(1, 0) << 1) | (at(0, 1) << 2) | (at(1, 1) << 3);
+            }
+        }
+
+        int operator[](const int window) const { return m_table[window]; }
+    };
+
+    namespace _misc {
+        // Calculate 2 lines from 4 wrapped lines (`make_wrapped_line`). `dest_1` may be null.
+        inline void apply_block_table(const block_tableT& table, uint64_t* const dest_0, uint64_t* const dest_1,
+                                      const uint64_t* const (&lines)[4], const int width) {
+            const int stride = packed_tileT::calc_stride(width);
+            for (int i = 0; i < stride; ++i) {
+                uint64_t l0 = lines[0][i], l1 = lines[1][i], l2 = lines[2][i], l3 = lines[3][i];
+                uint64_t word_0 = 0, word_1 = 0;
+                const int n = std::min(64, width - i * 64);
+                for (int b = 0; b < n; b += 2) {
+                    if (b == 62) { // Only 2 bits left in the current words.
+                        l0 |= lines[0][i + 1] << 2, l1 |= lines[1][i + 1] << 2;
+                        l2 |= lines[2][i + 1] << 2, l3 |= lines[3][i + 1] << 2;
+                    }
+                    const int block = table[(l0 & 0xf) | ((l1 & 0xf) << 4) | ((l2 & 0xf) << 8) | ((l3 & 0xf) << 12)];
+                    word_0 |= uint64_t(block & 0b11) << b;
+                    word_1 |= uint64_t(block >> 2) << b;
+                    l0 >>= 2, l1 >>= 2, l2 >>= 2, l3 >>= 2;
+                }
+                dest_0[i] = word_0;
+                if (dest_1) {
+                    dest_1[i] = word_1;
+                }
+            }
+            const uint64_t tail = ~uint64_t(0) >> (stride * 64 - width);
+            dest_0[stride - 1] &= tail;
+            if (dest_1) {
+                dest_1[stride - 1] &= tail;
+            }
+        }
+    } // namespace _misc
+
+    // Lines are calculated in pairs (from `y_begin`), with a single line at the end if the band height is odd.
+    inline void apply_rule_torus(const block_tableT& table, packed_tileT& dest, const packed_tileT& source,
+                                 const int y_begin, const int y_end, packed_scratchT& scratch) {
+        assert(&dest != &source && dest.size() == source.size());
+        assert(0 <= y_begin && y_begin <= y_end && y_end <= source.size().y);
+        const vecT size = source.size();
+        const int stride = source.stride();
+        const auto wrap = [&size](int y) { return (y + size.y) % size.y; }; // (For [-1, size.y + 2).)
+
+        uint64_t* const wrapped_data = scratch.reserve(4 * (stride + 1));
+        uint64_t* const lines[4]{wrapped_data, wrapped_data + (stride + 1), wrapped_data + 2 * (stride + 1),
+                                 wrapped_data + 3 * (stride + 1)};
+
+        for (int y = y_begin; y < y_end; y += 2) {
+            for (int r = 0; r < 4; ++r) {
+                _misc::make_wrapped_line(lines[r], source.line(wrap(y - 1 + r)), size.x);
+            }
+            _misc::apply_block_table(table, dest.line(y), y + 1 < y_end ? dest.line(y + 1) : nullptr, lines, size.x);
+        }
+    }
+
+    // The same as applying the table twice, in a single pass. (The intermediate generation is kept in a few
+    // lines, so the tiles are read and written only once, which is useful for strobing rules whose odd
+    // generations are never shown.)
+    inline void apply_rule_torus_2(const block_tableT& table, packed_tileT& dest, const packed_tileT& source,
+                                   const int y_begin, const int y_end, packed_scratchT& scratch) {
+        assert(&dest != &source && dest.size() == source.size());
+        assert(0 <= y_begin && y_begin <= y_end && y_end <= source.size().y);
+        const vecT size = source.size();
+        const int stride = source.stride();
+        const auto wrap = [&size](int y) { return ((y % size.y) + size.y) % size.y; };
+
+        // 4 wrapped source lines, 4 intermediate lines, 4 wrapped intermediate lines.
+        uint64_t* buf = scratch.reserve(8 * (stride + 1) + 4 * stride);
+        uint64_t* source_lines[4]{};
+        uint64_t* mid[4]{};
+        uint64_t* mid_lines[4]{};
+        for (uint64_t*& line : source_lines) {
+            line = std::exchange(buf, buf + stride + 1);
+        }
+        for (uint64_t*& line : mid) {
+            line = std::exchange(buf, buf + stride);
+        }
+        for (uint64_t*& line : mid_lines) {
+            line = std::exchange(buf, buf + stride + 1);
+        }
+
+        // Intermediate lines y and y + 1.
+        const auto mid_pair = [&](const int y, uint64_t* const mid_0, uint64_t* const mid_1) {
+            for (int r = 0; r < 4; ++r) {
+                _misc::make_wrapped_line(source_lines[r], source.line(wrap(y - 1 + r)), size.x);
+            }
+            _misc::apply_block_table(table, mid_0, mid_1, source_lines, size.x);
+        };
+
+        for (int y = y_begin; y < y_end; y += 2) {
+            // mid[0, 4) ~ intermediate lines [y - 1, y + 3).
+            if (y == y_begin) {
+                mid_pair(y - 1, mid[0], mid[1]);
+            } else {
+                std::swap(mid[0], mid[2]);
+                std::swap(mid[1], mid[3]);
+            }
+            mid_pair(y + 1, mid[2], mid[3]);
+            for (int r = 0; r < 4; ++r) {
+                _misc::make_wrapped_line(mid_lines[r], mid[r], size.x);
+            }
+            _misc::apply_block_table(table, dest.line(y), y + 1 < y_end ? dest.line(y + 1) : nullptr, mid_lines,
+                                     size.x);
+        }
+    }
+
+    // (With temporary scratch; for repeated stepping the scratch should be kept instead.)
+    template <class ruleT_>
+        requires(rule_like<ruleT_> || std::is_same_v<ruleT_, circuitT> || std::is_same_v<ruleT_, block_tableT>)
+    inline void apply_rule_torus(const ruleT_& rule, packed_tileT& dest, const packed_tileT& source,
+                                 const int y_begin, const int y_end) {
+        packed_scratchT scratch{};
+        apply_rule_torus(rule, dest, source, y_begin, y_end, scratch);
+    }
+
+    inline void apply_rule_torus_2(const block_tableT& table, packed_tileT& dest, const packed_tileT& source,
+                                   const int y_begin, const int y_end) {
+        packed_scratchT scratch{};
+        apply_rule_torus_2(table, dest, source, y_begin, y_end, scratch);
+    }
+
+    template <class ruleT_>
+        requires(rule_like<ruleT_> || std::is_same_v<ruleT_, circuitT> || std::is_same_v<ruleT_, block_tableT>)
+    inline void apply_rule_torus(const ruleT_& rule, packed_tileT& dest, const packed_tileT& source) {
+        apply_rule_torus(rule, dest, source, 0, source.size().y);
+    }
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_packed_helpers = [] {
+            for (const vecT size : {vecT{1, 1}, vecT{63, 3}, vecT{64, 2}, vecT{65, 4}, vecT{150, 7}}) {
+                tileT a(size), b(size);
+                random_fill(a.data(), testT::rand, 0.3);
+
+                packed_tileT p(size);
+                copy(p, a.data());
+                copy(b.data(), p);
+                assert(a == b);
+                assert(count(p) == count(a.data()));
+                for (const bool bg : {false, true}) {
+                    const rangeT r1 = bounding_box(p, bg), r2 = bounding_box(a.data(), bg);
+                    assert(r1.begin == r2.begin && r1.end == r2.end);
+                }
+
+                packed_tileT q(size);
+                fill(q, true);
+                assert(count(q) == size.xy());
+                blit<blitE::Xor>(q, p);
+                assert(count(q) == size.xy() - count(p));
+
+                const bool period[6]{1, 0, 0, 0, 1, 1};
+                fill(a.data(), {period, {3, 2}});
+                fill(q, {period, {3, 2}});
+                copy(b.data(), q);
+                assert(a == b);
+            }
+        };
+
+        inline const testT test_packed_apply = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            const circuitT circuit(rule);
+            for (const vecT size : {vecT{1, 1}, vecT{2, 5}, vecT{63, 3}, vecT{64, 4}, vecT{65, 2}, vecT{130, 9}}) {
+                tileT tile(size), compare(size);
+                random_fill(tile.data(), testT::rand, 0.5);
+                packed_tileT p(size), p2(size), p3(size);
+                copy(p, tile.data());
+                copy(p3, tile.data());
+                for (int g = 0; g < 4; ++g) {
+                    tile.run_torus(rule);
+                    apply_rule_torus(rule, p2, p);
+                    p.swap(p2);
+                    copy(compare.data(), p);
+                    assert(tile == compare);
+                    apply_rule_torus(circuit, p2, p3);
+                    p3.swap(p2);
+                    assert(p3 == p);
+                }
+            }
+        };
+
+        inline const testT test_block_table_apply = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            const block_tableT table(rule);
+            for (const vecT size : {vecT{1, 1}, vecT{2, 5}, vecT{3, 3}, vecT{63, 4}, vecT{64, 7}, vecT{131, 10}}) {
+                tileT tile(size), compare(size);
+                random_fill(tile.data(), testT::rand, 0.5);
+                packed_tileT p(size), p2(size);
+                copy(p, tile.data());
+                for (int g = 0; g < 4; ++g) {
+                    tile.run_torus(rule);
+                    // (Odd bands.)
+                    apply_rule_torus(table, p2, p, 0, size.y / 2 + (size.y > 2));
+                    apply_rule_torus(table, p2, p, size.y / 2 + (size.y > 2), size.y);
+                    p.swap(p2);
+                    copy(compare.data(), p);
+                    assert(tile == compare);
+                }
+                for (int g = 0; g < 2; ++g) {
+                    tile.run_torus(rule);
+                    tile.run_torus(rule);
+                    apply_rule_torus_2(table, p2, p, 0, size.y / 2 + (size.y > 2));
+                    apply_rule_torus_2(table, p2, p, size.y / 2 + (size.y > 2), size.y);
+                    p.swap(p2);
+                    copy(compare.data(), p);
+                    assert(tile == compare);
+                }
+            }
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "tile_packed.hpp"
+
+namespace aniso {
+    // Persistent threads for `run(n, fn)` ~ `for (int i = 0; i < n; ++i) { fn(i); }`, with the calls distributed
+    // among the workers and the calling thread.
+    class worker_poolT {
+        std::vector<std::thread> m_workers{};
+
+        std::mutex m_mut{};
+        std::condition_variable m_cond_start{}, m_cond_done{};
+        uint64_t m_epoch = 0; // Increased for each `run`.
+        int m_active = 0;     // Workers that are yet to finish the current `run`.
+        bool m_stop = false;
+
+        const std::function<void(int)>* m_task = nullptr;
+        int m_task_count = 0;
+        std::atomic_int m_next{0};
+
+        void work() {
+            for (int i; (i = m_next.fetch_add(1, std::memory_order_relaxed)) < m_task_count;) {
+                (*m_task)(i);
+            }
+        }
+
+        void worker_loop() {
+            uint64_t seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock lock(m_mut);
+                    m_cond_start.wait(lock, [&] { return m_stop || m_epoch != seen; });
+                    if (m_stop) {
+                        return;
+                    }
+                    seen = m_epoch;
+                }
+                work();
+                {
+                    std::unique_lock lock(m_mut);
+                    if (--m_active == 0) {
+                        m_cond_done.notify_one();
+                    }
+                }
+            }
+        }
+
+    public:
+        // (The calling thread also takes part, so `concurrency - 1` threads are created.)
+        explicit worker_poolT(int concurrency = std::thread::hardware_concurrency()) {
+            for (int i = 1; i < concurrency; ++i) {
+                m_workers.emplace_back([this] { worker_loop(); });
+            }
+        }
+
+        worker_poolT(const worker_poolT&) = delete;
+        worker_poolT& operator=(const worker_poolT&) = delete;
+
+        ~worker_poolT() {
+            {
+                std::unique_lock lock(m_mut);
+                m_stop = true;
+            }
+            m_cond_start.notify_all();
+            for (std::thread& worker : m_workers) {
+                worker.join();
+            }
+        }
+
+        int concurrency() const { return m_workers.size() + 1; }
+
+        // Not reentrant; should be called from a single thread.
+        void run(const int n, const std::function<void(int)>& fn) {
+            if (m_workers.empty() || n <= 1) {
+                for (int i = 0; i < n; ++i) {
+                    fn(i);
+                }
+                return;
+            }
+
+            {
+                std::unique_lock lock(m_mut);
+                m_task = &fn;
+                m_task_count = n;
+                m_next.store(0, std::memory_order_relaxed);
+                m_active = m_workers.size();
+                ++m_epoch;
+            }
+            m_cond_start.notify_all();
+            work();
+            {
+                std::unique_lock lock(m_mut);
+                m_cond_done.wait(lock, [&] { return m_active == 0; });
+                m_task = nullptr;
+            }
+        }
+    };
+
+    namespace _misc {
+        // Split [0, height) into at most `n` bands of similar heights.
+        inline std::vector<std::pair<int, int>> make_bands(const int height, int n) {
+            constexpr int min_height = 16; // (Thinner bands are not worth the synchronization.)
+            n = std::clamp(std::min(n, height / min_height), 1, height);
+            std::vector<std::pair<int, int>> bands;
+            for (int i = 0; i < n; ++i) {
+                bands.emplace_back(height * i / n, height * (i + 1) / n);
+            }
+            return bands;
+        }
+
+        // The border of `range` in the torus space.
+        inline void collect_torus_border(const border_ref border, const tile_const_ref source, const rangeT& range) {
+            const vecT size = source.size;
+            assert(border.size == range.size());
+            const auto wrap = [](int v, int r) { return v < 0 ? v + r : v >= r ? v - r : v; };
+            const int xl = wrap(range.begin.x - 1, size.x), xr = wrap(range.end.x, size.x);
+            std::copy_n(source.line(wrap(range.begin.y - 1, size.y)) + range.begin.x, border.size.x, border.up_line());
+            std::copy_n(source.line(wrap(range.end.y, size.y)) + range.begin.x, border.size.x, border.down_line());
+            for (int y = -1; y <= border.size.y; ++y) {
+                const bool* const line = source.line(wrap(range.begin.y + y, size.y));
+                border.set_lr(y, line[xl], line[xr]);
+            }
+        }
+    } // namespace _misc
+
+    // Banded stepping: the tile is split into horizontal bands, which are calculated concurrently in the pool.
+    // The bands and their scratch buffers are kept, so that repeated stepping doesn't allocate (except when the
+    // size or the concurrency changes).
+    class banded_stepperT {
+        std::vector<std::pair<int, int>> m_bands{};
+        int m_height = 0, m_concurrency = 0;
+        std::vector<packed_scratchT> m_scratch{}; // For each band.
+        vecT m_byte_size{};
+        int m_border_size = 0;               // (Of the highest band.)
+        std::unique_ptr<bool[]> m_borders{}; // (For the byte kernel.)
+        std::unique_ptr<char[]> m_vec_p6{};
+        int m_alloc_count = 0;
+
+        void prepare(const int height, const worker_poolT& pool) {
+            if (m_height != height || m_concurrency != pool.concurrency()) {
+                m_height = height;
+                m_concurrency = pool.concurrency();
+                m_bands = _misc::make_bands(height, m_concurrency);
+                if (m_scratch.size() < m_bands.size()) {
+                    m_scratch.resize(m_bands.size());
+                }
+                m_byte_size = {};
+                ++m_alloc_count;
+            }
+        }
+
+        // (The task is passed to `pool.run` by a lambda that captures only a reference to it, which is small
+        // enough not to be allocated by `std::function`.)
+        void run_bands(worker_poolT& pool, const auto& task) {
+            pool.run(m_bands.size(), [&task](const int i) { task(i); });
+        }
+
+    public:
+        // Times the scratch buffers are (re)allocated.
+        int alloc_count() const {
+            int count = m_alloc_count;
+            for (const packed_scratchT& scratch : m_scratch) {
+                count += scratch.alloc_count();
+            }
+            return count;
+        }
+
+        // The same as `apply_rule_torus(rule, dest, source)`. (`dest` and `source` should not overlap.)
+        void run(const rule_like auto& rule, worker_poolT& pool, const tile_ref dest, const tile_const_ref source) {
+            assert(source.size == dest.size);
+            const vecT size = source.size;
+            prepare(size.y, pool);
+            if (m_byte_size != size) {
+                m_byte_size = size;
+                int max_height = 0;
+                for (const auto& [y_begin, y_end] : m_bands) {
+                    max_height = std::max(max_height, y_end - y_begin);
+                }
+                m_border_size = calc_border_size({size.x, max_height});
+                m_borders = std::make_unique_for_overwrite<bool[]>(m_bands.size() * m_border_size);
+                m_vec_p6 = std::make_unique_for_overwrite<char[]>(m_bands.size() * size.x);
+                ++m_alloc_count;
+            }
+
+            run_bands(pool, [&](const int i) {
+                const auto [y_begin, y_end] = m_bands[i];
+                const rangeT range{{0, y_begin}, {size.x, y_end}};
+                const border_ref border{.size = range.size(), .data = m_borders.get() + i * m_border_size};
+                _misc::collect_torus_border(border, source, range);
+                apply_rule(rule, dest.clip(range), source.clip(range), border, m_vec_p6.get() + i * size.x);
+            });
+        }
+
+        // The same as `apply_rule_torus(kernel, dest, source)` for the packed kernels (including the family
+        // kernel).
+        template <class kernelT>
+        void run(const kernelT& kernel, worker_poolT& pool, packed_tileT& dest, const packed_tileT& source) {
+            prepare(source.size().y, pool);
+            run_bands(pool, [&](const int i) {
+                const auto [y_begin, y_end] = m_bands[i];
+                apply_rule_torus(kernel, dest, source, y_begin, y_end, m_scratch[i]);
+            });
+        }
+
+        void run_2(const block_tableT& table, worker_poolT& pool, packed_tileT& dest, const packed_tileT& source) {
+            prepare(source.size().y, pool);
+            run_bands(pool, [&](const int i) {
+                const auto [y_begin, y_end] = m_bands[i];
+                apply_rule_torus_2(table, dest, source, y_begin, y_end, m_scratch[i]);
+            });
+        }
+    };
+
+    // The same as `apply_rule_torus(rule, dest, source)`, with horizontal bands calculated in the pool.
+    // (With temporary scratch; for repeated stepping `banded_stepperT` should be kept instead.)
+    // (`dest` and `source` should not overlap.)
+    inline void apply_rule_torus(const rule_like auto& rule, worker_poolT& pool, const tile_ref dest,
+                                 const tile_const_ref source) {
+        banded_stepperT().run(rule, pool, dest, source);
+    }
+
+    template <class ruleT_>
+        requires(rule_like<ruleT_> || std::is_same_v<ruleT_, circuitT> || std::is_same_v<ruleT_, block_tableT>)
+    inline void apply_rule_torus(const ruleT_& rule, worker_poolT& pool, packed_tileT& dest,
+                                 const packed_tileT& source) {
+        banded_stepperT().run(rule, pool, dest, source);
+    }
+
+    inline void apply_rule_torus_2(const block_tableT& table, worker_poolT& pool, packed_tileT& dest,
+                                   const packed_tileT& source) {
+        banded_stepperT().run_2(table, pool, dest, source);
+    }
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_parallel_apply = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            const circuitT circuit(rule);
+            worker_poolT pool(4);
+            for (const vecT size : {vecT{1, 1}, vecT{5, 40}, vecT{70, 67}, vecT{130, 100}}) {
+                tileT tile(size), a(size), b(size);
+                random_fill(tile.data(), testT::rand, 0.5);
+                copy(a.data(), tile.data());
+                packed_tileT p(size), p2(size);
+                copy(p, tile.data());
+                for (int g = 0; g < 4; ++g) {
+                    tile.run_torus(rule);
+                    apply_rule_torus(rule, pool, b.data(), a.data());
+                    a.swap(b);
+                    assert(a == tile);
+                    apply_rule_torus(circuit, pool, p2, p);
+                    p.swap(p2);
+                    copy(b.data(), p);
+                    assert(b == tile);
+                }
+                const block_tableT table(rule);
+                tile.run_torus(rule);
+                tile.run_torus(rule);
+                apply_rule_torus_2(table, pool, p2, p);
+                copy(b.data(), p2);
+                assert(b == tile);
+            }
+        };
+
+        inline const testT test_banded_stepper = [] {
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            const circuitT circuit(rule);
+            const block_tableT table(rule);
+            worker_poolT pool(4);
+            banded_stepperT stepper;
+            for (const vecT size : {vecT{70, 67}, vecT{130, 100}}) {
+                tileT tile(size), a(size), b(size);
+                random_fill(tile.data(), testT::rand, 0.5);
+                copy(a.data(), tile.data());
+                packed_tileT p(size), p2(size);
+                copy(p, tile.data());
+                int allocs = 0;
+                for (int g = 0; g < 3; ++g) {
+                    for (int c = 0; c < 4; ++c) {
+                        tile.run_torus(rule);
+                        stepper.run(rule, pool, b.data(), a.data());
+                        a.swap(b);
+                    }
+                    assert(a == tile);
+                    stepper.run(circuit, pool, p2, p);
+                    stepper.run(table, pool, p, p2);
+                    stepper.run_2(table, pool, p2, p);
+                    p.swap(p2);
+                    copy(b.data(), p);
+                    assert(b == tile);
+
+                    // (The buffers are allocated only in the first round.)
+                    if (g == 0) {
+                        allocs = stepper.alloc_count();
+                    } else {
+                        assert(stepper.alloc_count() == allocs);
+                    }
+                }
+            }
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstring>
+
+#include "tile_packed.hpp"
+
+// SSE2 is always available for x86-64, and AVX2 is detected at runtime (can be disabled by DISABLE_SIMD).
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(DISABLE_SIMD)
+#define ANISO_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ANISO_TARGET_AVX2
+#else
+#define ANISO_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif // x86-64
+
+namespace aniso {
+    // Expanding cells to 32-bit pixels (`c0` for 0 and `c1` for 1), for the textures.
+    // The cells are either bools (`tileT`) or bits (`packed_tileT`, bit i of the words ~ cell i).
+    struct pixel_kernelsT {
+        const char* name;
+        void (*bytes)(const bool* source, uint32_t* dest, int n, uint32_t c0, uint32_t c1);
+        void (*bits)(const uint64_t* source, uint32_t* dest, int n, uint32_t c0, uint32_t c1);
+    };
+
+    namespace _misc {
+        // (`mask` ~ all 1 or all 0.)
+        inline uint32_t select_color(const uint32_t mask, const uint32_t c0, const uint32_t c1) {
+            return c0 ^ (mask & (c0 ^ c1));
+        }
+
+        inline void expand_bytes_portable(const bool* const source, uint32_t* const dest, const int n,
+                                          const uint32_t c0, const uint32_t c1) {
+            for (int i = 0; i < n; ++i) {
+                dest[i] = select_color(-uint32_t(source[i]), c0, c1);
+            }
+        }
+
+        inline void expand_bits_portable(const uint64_t* const source, uint32_t* const dest, const int n,
+                                         const uint32_t c0, const uint32_t c1) {
+            for (int i = 0; i < n; ++i) {
+                dest[i] = select_color(-uint32_t((source[i / 64] >> (i % 64)) & 1), c0, c1);
+            }
+        }
+
+#ifdef ANISO_SIMD
+        // 16 cells per iteration; each byte (0 or 1) is turned into a byte mask and then widened by unpacking
+        // with itself.
+        inline void expand_bytes_sse2(const bool* const source, uint32_t* const dest, const int n,
+                                      const uint32_t c0, const uint32_t c1) {
+            const __m128i v0 = _mm_set1_epi32(c0), diff = _mm_set1_epi32(c0 ^ c1);
+            const auto put = [&](uint32_t* p, __m128i mask) {
+                _mm_storeu_si128((__m128i*)p, _mm_xor_si128(v0, _mm_and_si128(mask, diff)));
+            };
+            int i = 0;
+            for (; i + 16 <= n; i += 16) {
+                const __m128i b = _mm_sub_epi8(_mm_setzero_si128(), _mm_loadu_si128((const __m128i*)(source + i)));
+                const __m128i lo = _mm_unpacklo_epi8(b, b), hi = _mm_unpackhi_epi8(b, b);
+                put(dest + i, _mm_unpacklo_epi16(lo, lo));
+                put(dest + i + 4, _mm_unpackhi_epi16(lo, lo));
+                put(dest + i + 8, _mm_unpacklo_epi16(hi, hi));
+                put(dest + i + 12, _mm_unpackhi_epi16(hi, hi));
+            }
+            expand_bytes_portable(source + i, dest + i, n - i, c0, c1);
+        }
+
+        // 8 cells per iteration; the byte is broadcast and tested against the bit of each lane.
+        inline void expand_bits_sse2(const uint64_t* const source, uint32_t* const dest, const int n,
+                                     const uint32_t c0, const uint32_t c1) {
+            const __m128i v0 = _mm_set1_epi32(c0), diff = _mm_set1_epi32(c0 ^ c1);
+            const __m128i bits_lo = _mm_setr_epi32(1, 2, 4, 8), bits_hi = _mm_setr_epi32(16, 32, 64, 128);
+            const uint8_t* const bytes = (const uint8_t*)source; // (Little-endian.)
+            int i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m128i b = _mm_set1_epi32(bytes[i / 8]);
+                const __m128i m_lo = _mm_cmpeq_epi32(_mm_and_si128(b, bits_lo), bits_lo);
+                const __m128i m_hi = _mm_cmpeq_epi32(_mm_and_si128(b, bits_hi), bits_hi);
+                _mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(v0, _mm_and_si128(m_lo, diff)));
+                _mm_storeu_si128((__m128i*)(dest + i + 4), _mm_xor_si128(v0, _mm_and_si128(m_hi, diff)));
+            }
+            for (; i < n; ++i) {
+                dest[i] = select_color(-uint32_t((bytes[i / 8] >> (i % 8)) & 1), c0, c1);
+            }
+        }
+
+        ANISO_TARGET_AVX2 inline void expand_bytes_avx2(const bool* const source, uint32_t* const dest, const int n,
+                                                        const uint32_t c0, const uint32_t c1) {
+            const __m256i v0 = _mm256_set1_epi32(c0), diff = _mm256_set1_epi32(c0 ^ c1);
+            int i = 0;
+            for (; i + 16 <= n; i += 16) {
+                // (A lambda would not inherit the target attribute.)
+                const __m128i b = _mm_loadu_si128((const __m128i*)(source + i));
+                const __m256i m_lo = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_cvtepu8_epi32(b));
+                const __m256i m_hi =
+                    _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_cvtepu8_epi32(_mm_srli_si128(b, 8)));
+                _mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(v0, _mm256_and_si256(m_lo, diff)));
+                _mm256_storeu_si256((__m256i*)(dest + i + 8), _mm256_xor_si256(v0, _mm256_and_si256(m_hi, diff)));
+            }
+            expand_bytes_portable(source + i, dest + i, n - i, c0, c1);
+        }
+
+        ANISO_TARGET_AVX2 inline void expand_bits_avx2(const uint64_t* const source, uint32_t* const dest,
+                                                       const int n, const uint32_t c0, const uint32_t c1) {
+            const __m256i v0 = _mm256_set1_epi32(c0), diff = _mm256_set1_epi32(c0 ^ c1);
+            const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+            const uint8_t* const bytes = (const uint8_t*)source;
+            int i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m256i b = _mm256_set1_epi32(bytes[i / 8]);
+                const __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(b, bits), bits);
+                _mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(v0, _mm256_and_si256(mask, diff)));
+            }
+            for (; i < n; ++i) {
+                dest[i] = select_color(-uint32_t((bytes[i / 8] >> (i % 8)) & 1), c0, c1);
+            }
+        }
+
+        inline bool has_avx2() {
+#ifdef _MSC_VER
+            int info[4]{};
+            __cpuid(info, 0);
+            if (info[0] < 7) {
+                return false;
+            }
+            __cpuid(info, 1);
+            const bool osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+            if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) { // (The OS should save the ymm registers.)
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return info[1] & (1 << 5);
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif // ANISO_SIMD
+    } // namespace _misc
+
+    // All the kernels supported by this machine, the best one first. (The last one is the portable version.)
+    inline std::span<const pixel_kernelsT> all_pixel_kernels() {
+        using namespace _misc;
+        static const std::vector<pixel_kernelsT> kernels = [] {
+            std::vector<pixel_kernelsT> kernels;
+#ifdef ANISO_SIMD
+            if (has_avx2()) {
+                kernels.push_back({"AVX2", expand_bytes_avx2, expand_bits_avx2});
+            }
+            kernels.push_back({"SSE2", expand_bytes_sse2, expand_bits_sse2});
+#endif
+            kernels.push_back({"Portable", expand_bytes_portable, expand_bits_portable});
+            return kernels;
+        }();
+        return kernels;
+    }
+
+    inline const pixel_kernelsT& pixel_kernels() {
+        static const pixel_kernelsT& best = all_pixel_kernels().front();
+        return best;
+    }
+
+    inline void expand_pixels(const bool* const source, uint32_t* const dest, const int n, const uint32_t c0,
+                              const uint32_t c1) {
+        pixel_kernels().bytes(source, dest, n, c0, c1);
+    }
+
+    // (The line starts at bit 0 of `source[0]`.)
+    inline void expand_pixels(const uint64_t* const source, uint32_t* const dest, const int n, const uint32_t c0,
+                              const uint32_t c1) {
+        pixel_kernels().bits(source, dest, n, c0, c1);
+    }
+
+    // For zoomed-out views, each `block` * `block` area (block = 2, 4 or 8) is turned into a pixel, blended between
+    // `c0` and `c1` by the portion of 1 in the area. (The areas at the right and bottom edges may be smaller.)
+    inline vecT density_size(const vecT size, const int block) {
+        return {.x = (size.x + block - 1) / block, .y = (size.y + block - 1) / block};
+    }
+
+    namespace _misc {
+        inline uint32_t mix_color(const uint32_t c0, const uint32_t c1, const int count, const int area) {
+            uint32_t c = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int v0 = (c0 >> shift) & 0xff, v1 = (c1 >> shift) & 0xff;
+                c |= uint32_t((v0 * (area - count) + v1 * count + area / 2) / area) << shift;
+            }
+            return c;
+        }
+    } // namespace _misc
+
+    // The rows of the area are summed bytewise (8 cells in a word), and then the adjacent bytes in each word are
+    // added up in place (SWAR), so that the word holds the counts of `8 / block` areas. (Relying on little-endian.)
+    inline void expand_density(const tile_const_ref source, const int block, uint32_t* const dest,
+                               const int dest_stride, const uint32_t c0, const uint32_t c1) {
+        assert(block == 2 || block == 4 || block == 8);
+        const int width = source.size.x;
+        const vecT size = density_size(source.size, block);
+        const int words = (width + 7) / 8, full_words = width / 8;
+        std::vector<uint64_t> sums(words); // (At most 8 per byte.)
+
+        uint32_t full[65]; // Count -> color, for the full areas.
+        for (int c = 0; c <= block * block; ++c) {
+            full[c] = _misc::mix_color(c0, c1, c, block * block);
+        }
+
+        constexpr uint64_t mask_8 = 0x00ff00ff00ff00ff, mask_16 = 0x0000ffff0000ffff, mask_32 = 0xffffffff;
+        const int lanes = 8 / block, lane_bits = 8 * block;
+        for (int dy = 0; dy < size.y; ++dy) {
+            const int y0 = dy * block, y1 = std::min(source.size.y, y0 + block);
+            std::ranges::fill(sums, 0);
+            for (int y = y0; y < y1; ++y) {
+                const bool* const line = source.line(y);
+                for (int w = 0; w < full_words; ++w) {
+                    uint64_t v;
+                    std::memcpy(&v, line + w * 8, 8);
+                    sums[w] += v;
+                }
+                if (full_words != words) {
+                    uint64_t v = 0;
+                    std::memcpy(&v, line + full_words * 8, width - full_words * 8);
+                    sums[full_words] += v;
+                }
+            }
+
+            uint32_t* const out = dest + dy * dest_stride;
+            for (int w = 0; w < words; ++w) {
+                uint64_t v = sums[w];
+                v = (v & mask_8) + ((v >> 8) & mask_8);
+                if (block >= 4) {
+                    v = (v & mask_16) + ((v >> 16) & mask_16);
+                }
+                if (block == 8) {
+                    v = (v & mask_32) + (v >> 32);
+                }
+                if (w < full_words && y1 - y0 == block) { // (Full areas only.)
+                    for (int l = 0; l < lanes; ++l) {
+                        out[w * lanes + l] = full[(v >> (l * lane_bits)) & 0xffff];
+                    }
+                    continue;
+                }
+                for (int l = 0; l < lanes; ++l) {
+                    const int x = w * lanes + l;
+                    if (x >= size.x) {
+                        break;
+                    }
+                    const int count = (v >> (l * lane_bits)) & 0xffff; // (At most 64.)
+                    const int area = (y1 - y0) * std::min(block, width - x * block);
+                    out[x] = area == block * block ? full[count] : _misc::mix_color(c0, c1, count, area);
+                }
+            }
+        }
+    }
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_expand_density = [] {
+            const uint32_t c0 = 0x12345678, c1 = 0xff00ff00;
+            for (const vecT size : {vecT{1, 1}, vecT{8, 8}, vecT{13, 7}, vecT{70, 33}}) {
+                tileT tile(size);
+                random_fill(tile.data(), testT::rand, 0.5);
+                for (const int block : {2, 4, 8}) {
+                    const vecT d_size = density_size(size, block);
+                    std::vector<uint32_t> pixels(d_size.xy());
+                    expand_density(tile.data(), block, pixels.data(), d_size.x, c0, c1);
+                    for (int y = 0; y < d_size.y; ++y) {
+                        for (int x = 0; x < d_size.x; ++x) {
+                            const rangeT range = common({{x * block, y * block}, {(x + 1) * block, (y + 1) * block}},
+                                                        {{0, 0}, size});
+                            const int c = count(tile.data().clip(range)), area = range.size().xy();
+                            assert(pixels[y * d_size.x + x] == _misc::mix_color(c0, c1, c, area));
+                        }
+                    }
+                }
+            }
+        };
+
+        inline const testT test_pixel_kernels = [] {
+            const uint32_t c0 = 0x12345678, c1 = 0xff00ff00;
+            for (const int n : {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 130}) {
+                tileT tile({n + 5, 1});
+                random_fill(tile.data(), testT::rand, 0.5);
+                packed_tileT packed({n + 5, 1});
+                copy(packed, tile.data());
+
+                std::vector<uint32_t> expected(n + 1, 0), a(n + 1, 0), b(n + 1, 0);
+                for (int i = 0; i < n; ++i) {
+                    expected[i] = tile.data().at(i, 0) ? c1 : c0;
+                }
+                for (const pixel_kernelsT& kernels : all_pixel_kernels()) {
+                    kernels.bytes(tile.data().line(0), a.data(), n, c0, c1);
+                    kernels.bits(packed.line(0), b.data(), n, c0, c1);
+                    assert(a == expected && b == expected); // (Including the untouched end.)
+                }
+                // Unaligned source.
+                if (n > 0) {
+                    for (const pixel_kernelsT& kernels : all_pixel_kernels()) {
+                        kernels.bytes(tile.data().line(0) + 3, a.data(), n, c0, c1);
+                        for (int i = 0; i < n; ++i) {
+                            assert(a[i] == (tile.data().at(i + 3, 0) ? c1 : c0));
+                        }
+                    }
+                }
+            }
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso
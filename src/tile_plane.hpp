@@ -0,0 +1,283 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tile_parallel.hpp"
+
+namespace aniso {
+    // The unbounded plane, as the periodic background overwritten by fixed-size chunks where it may differ.
+    // Only the chunks and their neighbors reached by the non-background cells are calculated, and the chunks
+    // that return to the background are freed, so the costs scale with the active area (instead of the bounding
+    // box of the pattern).
+    class sparse_planeT {
+        static constexpr int base_chunk_size = 64;
+
+        struct hashT {
+            size_t operator()(const vecT& p) const {
+                return std::hash<uint64_t>{}((uint64_t(uint32_t(p.x)) << 32) | uint32_t(p.y));
+            }
+        };
+
+        vecT m_chunk_size{}; // (Multiple of the background size, so that every chunk is aligned with it.)
+        tileT m_background{}; // At the current generation; `m_background.at(0, 0)` is bound to plane (0, 0).
+        tileT m_bg_chunk{};   // The background of a chunk.
+        torus_stepperT m_bg_stepper{};
+        std::unordered_map<vecT, tileT, hashT> m_chunks{}; // Chunk pos -> chunk (not background).
+        uint64_t m_gen = 0;
+
+        // Reused by `step`.
+        std::unordered_set<vecT, hashT> m_target_set{};
+        std::vector<vecT> m_targets{};
+        std::vector<tileT> m_results{}, m_free{};
+        std::unique_ptr<bool[]> m_borders{}; // Scratch for `apply_rule`, one part for each task.
+        std::unique_ptr<char[]> m_vec_p6{};
+        int m_scratch_count = 0;
+
+        static int floor_div(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+        tile_const_ref chunk_at(const vecT pos) const {
+            const auto find = m_chunks.find(pos);
+            return find != m_chunks.end() ? find->second.data() : m_bg_chunk.data();
+        }
+
+        tileT take_free() {
+            if (m_free.empty()) {
+                return tileT(m_chunk_size);
+            }
+            tileT tile = std::move(m_free.back());
+            m_free.pop_back();
+            return tile;
+        }
+
+        // Call `fn(chunk pos, area)` for each chunk overlapping with `area`, with the overlapped area (both
+        // relative to the plane).
+        void for_each_chunk(const rangeT& area, const auto& fn) const {
+            if (area.empty()) {
+                return;
+            }
+            const vecT c0{floor_div(area.begin.x, m_chunk_size.x), floor_div(area.begin.y, m_chunk_size.y)};
+            const vecT c1{floor_div(area.end.x - 1, m_chunk_size.x), floor_div(area.end.y - 1, m_chunk_size.y)};
+            for (int cy = c0.y; cy <= c1.y; ++cy) {
+                for (int cx = c0.x; cx <= c1.x; ++cx) {
+                    const vecT chunk_begin{cx * m_chunk_size.x, cy * m_chunk_size.y};
+                    fn(vecT{cx, cy}, common(area, {chunk_begin, chunk_begin + m_chunk_size}));
+                }
+            }
+        }
+
+        // Add the chunk and its neighbors that may be affected by it in the next generation.
+        void add_targets(const vecT pos, const tile_const_ref chunk) {
+            const tile_const_ref bg = m_bg_chunk.data();
+            const vecT size = m_chunk_size;
+            const auto differs = [&](const rangeT& range) { return !equal(chunk.clip(range), bg.clip(range)); };
+            const bool up = differs({{0, 0}, {size.x, 1}}), down = differs({{0, size.y - 1}, size});
+            const bool left = differs({{0, 0}, {1, size.y}}), right = differs({{size.x - 1, 0}, size});
+            const auto add = [&](int dx, int dy, bool v) {
+                if (v) {
+                    m_target_set.insert(pos.plus(dx, dy));
+                }
+            };
+            add(0, 0, true);
+            add(0, -1, up), add(0, 1, down), add(-1, 0, left), add(1, 0, right);
+            add(-1, -1, up && chunk.at(0, 0) != bg.at(0, 0));
+            add(1, -1, up && chunk.at(size.x - 1, 0) != bg.at(size.x - 1, 0));
+            add(-1, 1, down && chunk.at(0, size.y - 1) != bg.at(0, size.y - 1));
+            add(1, 1, down && chunk.at(size.x - 1, size.y - 1) != bg.at(size.x - 1, size.y - 1));
+        }
+
+        void step(const rule_like auto& rule, worker_poolT& pool) {
+            m_target_set.clear();
+            for (const auto& [pos, chunk] : m_chunks) {
+                add_targets(pos, chunk.data());
+            }
+            m_targets.assign(m_target_set.begin(), m_target_set.end());
+
+            const int n = m_targets.size();
+            if (int(m_results.size()) < n) {
+                m_results.resize(n);
+            }
+            for (int i = 0; i < n; ++i) {
+                if (m_results[i].empty()) {
+                    m_results[i] = take_free();
+                }
+            }
+            const int tasks = std::min(n, pool.concurrency());
+            if (m_scratch_count < tasks) {
+                m_scratch_count = tasks;
+                m_borders = std::make_unique_for_overwrite<bool[]>(tasks * calc_border_size(m_chunk_size));
+                m_vec_p6 = std::make_unique_for_overwrite<char[]>(tasks * m_chunk_size.x);
+            }
+            pool.run(tasks, [&](const int t) {
+                const border_ref border{.size = m_chunk_size,
+                                        .data = m_borders.get() + t * calc_border_size(m_chunk_size)};
+                char* const vec_p6 = m_vec_p6.get() + t * m_chunk_size.x;
+                for (int i = n * t / tasks; i < n * (t + 1) / tasks; ++i) {
+                    const vecT p = m_targets[i];
+                    border.collect_from(chunk_at(p.plus(-1, -1)), chunk_at(p.plus(0, -1)), chunk_at(p.plus(1, -1)),
+                                        chunk_at(p.plus(-1, 0)), /*                     */ chunk_at(p.plus(1, 0)),
+                                        chunk_at(p.plus(-1, 1)), chunk_at(p.plus(0, 1)), chunk_at(p.plus(1, 1)));
+                    apply_rule(rule, m_results[i].data(), chunk_at(p), border, vec_p6);
+                }
+            });
+
+            m_bg_stepper.run_torus(rule, m_background.data(), 1);
+            fill(m_bg_chunk.data(), m_background.data());
+            ++m_gen;
+
+            // (The results that are not kept are left in `m_results` for the next step.)
+            for (int i = 0; i < n; ++i) {
+                tileT& result = m_results[i];
+                const bool is_bg = equal(result.data(), m_bg_chunk.data());
+                if (const auto find = m_chunks.find(m_targets[i]); find != m_chunks.end()) {
+                    if (is_bg) {
+                        m_free.push_back(std::move(find->second));
+                        m_chunks.erase(find);
+                    } else {
+                        find->second.swap(result);
+                    }
+                } else if (!is_bg) {
+                    m_chunks.emplace(m_targets[i], std::move(result));
+                }
+            }
+            trim();
+        }
+
+        // Release the reused buffers beyond what the next step may need, so that the memory shrinks back when the
+        // active area does. (Only when they are more than twice the need, so that they are not reallocated in
+        // every step.)
+        void trim() {
+            const size_t keep = 9 * m_chunks.size() + 16; // (A chunk adds at most 9 targets.)
+            const auto trim_vec = [keep](auto& vec) {
+                if (vec.capacity() > 2 * keep) {
+                    vec.resize(std::min(vec.size(), keep));
+                    vec.shrink_to_fit();
+                }
+            };
+            trim_vec(m_results);
+            trim_vec(m_free);
+            trim_vec(m_targets);
+            if (m_target_set.bucket_count() > 2 * keep) {
+                m_target_set.clear();
+                m_target_set.rehash(0);
+            }
+            if (m_chunks.bucket_count() > 2 * keep) {
+                m_chunks.rehash(0);
+            }
+        }
+
+    public:
+        sparse_planeT() { set_plane(tileT({1, 1}).data()); }
+
+        // The plane is `background` (periodic, bound to plane (0, 0)) everywhere.
+        void set_plane(const tile_const_ref background) {
+            m_background = tileT(background);
+            m_chunk_size = divmul_ceil({base_chunk_size, base_chunk_size}, background.size);
+            m_bg_chunk = tileT(m_chunk_size);
+            fill(m_bg_chunk.data(), background);
+            m_chunks.clear();
+            m_results.clear();
+            m_free.clear();
+            m_gen = 0;
+            m_scratch_count = 0; // (The chunk size may change.)
+        }
+
+        // Overwrite the area [begin, begin + pattern.size).
+        void write(const tile_const_ref pattern, const vecT begin) {
+            for_each_chunk({begin, begin + pattern.size}, [&](const vecT pos, const rangeT& area) {
+                auto [find, inserted] = m_chunks.try_emplace(pos);
+                tileT& chunk = find->second;
+                if (inserted) {
+                    chunk = take_free();
+                    copy(chunk.data(), m_bg_chunk.data());
+                }
+                const vecT chunk_begin{pos.x * m_chunk_size.x, pos.y * m_chunk_size.y};
+                copy(chunk.data().clip({area.begin - chunk_begin, area.end - chunk_begin}),
+                     pattern.clip({area.begin - begin, area.end - begin}));
+                if (equal(chunk.data(), m_bg_chunk.data())) {
+                    m_free.push_back(std::move(chunk));
+                    m_chunks.erase(find);
+                }
+            });
+        }
+
+        // Set `dest` to the area [begin, begin + dest.size).
+        void read(const tile_ref dest, const vecT begin) const {
+            for_each_chunk({begin, begin + dest.size}, [&](const vecT pos, const rangeT& area) {
+                const vecT chunk_begin{pos.x * m_chunk_size.x, pos.y * m_chunk_size.y};
+                copy(dest.clip({area.begin - begin, area.end - begin}),
+                     chunk_at(pos).clip({area.begin - chunk_begin, area.end - chunk_begin}));
+            });
+        }
+
+        void run(const rule_like auto& rule, worker_poolT& pool, const int count) {
+            for (int c = 0; c < count; ++c) {
+                step(rule, pool);
+            }
+        }
+
+        // Call `fn(begin, chunk)` for each chunk (that is not background).
+        void for_each_stored_chunk(const auto& fn) const {
+            for (const auto& [pos, chunk] : m_chunks) {
+                fn(vecT{pos.x * m_chunk_size.x, pos.y * m_chunk_size.y}, chunk.data());
+            }
+        }
+
+        // At the current generation; bound to plane (0, 0).
+        tile_const_ref background() const { return m_background.data(); }
+
+        uint64_t gen() const { return m_gen; }
+        int chunk_count() const { return m_chunks.size(); }
+        // Chunk buffers kept for reuse. (At most a few times `chunk_count()` after each step.)
+        int spare_count() const { return m_results.size() + m_free.size(); }
+        vecT chunk_size() const { return m_chunk_size; }
+    };
+
+#ifdef ENABLE_TESTS
+    namespace _tests {
+        inline const testT test_sparse_plane = [] {
+            worker_poolT pool(3);
+            const ruleT rule = make_rule([](codeT) { return testT::rand() & 1; });
+            tileT background({2, 3});
+            random_fill(background.data(), testT::rand, 0.5);
+
+            // (The changes cannot reach the border of the torus in 30 generations.)
+            const vecT torus_begin{-96, -96}; // (Aligned with the background.)
+            tileT torus({192, 192}), compare({192, 192});
+            fill(torus.data(), background.data());
+            tileT pattern({9, 7});
+            random_fill(pattern.data(), testT::rand, 0.5);
+            const vecT pattern_begin{-5, -3}; // (Across the chunks.)
+            copy(torus.data().clip({pattern_begin - torus_begin, pattern_begin - torus_begin + pattern.size()}),
+                 pattern.data());
+
+            sparse_planeT plane;
+            plane.set_plane(background.data());
+            plane.write(pattern.data(), pattern_begin);
+            for (const int gens : {1, 4, 2, 13, 10}) {
+                plane.run(rule, pool, gens);
+                torus.run_torus(rule, gens, tileT::engineE::Plain);
+                plane.read(compare.data(), torus_begin);
+                assert(torus == compare);
+            }
+            assert(plane.gen() == 30);
+
+            // The chunks are freed when the pattern dies out.
+            plane.set_plane(tileT({1, 1}).data());
+            plane.write(pattern.data(), {1000, -1000});
+            assert(plane.chunk_count() != 0);
+            plane.run(ruleT{}, pool, 1);
+            assert(plane.chunk_count() == 0);
+
+            // The spare buffers are released as well after a large pattern dies out.
+            tileT soup({2000, 2000});
+            random_fill(soup.data(), testT::rand, 0.5);
+            plane.write(soup.data(), {-1000, -1000});
+            assert(plane.chunk_count() > 900);
+            plane.run(ruleT{}, pool, 1);
+            assert(plane.chunk_count() == 0 && plane.spare_count() <= 2 * 16); // (Both lists are trimmed to 16.)
+        };
+    } // namespace _tests
+#endif // ENABLE_TESTS
+
+} // namespace aniso